@@ -3,6 +3,13 @@
 
 
 #include "RcppSimdJson/deserialize.hpp"
+#include "RcppSimdJson/aggregate.hpp"
+#include "RcppSimdJson/columns.hpp"
+#include "RcppSimdJson/arrow.hpp"
+#include "RcppSimdJson/arrow_ipc.hpp"
+#include "RcppSimdJson/csv.hpp"
+#include "RcppSimdJson/serialize.hpp"
+#include "RcppSimdJson/ndjson.hpp"
 
 
 #endif
@@ -0,0 +1,168 @@
+#ifndef RCPPSIMDJSON_AGGREGATE_HPP
+#define RCPPSIMDJSON_AGGREGATE_HPP
+
+
+#include "common.hpp"
+#include "pointer.hpp"
+
+#include <limits>        /* std::numeric_limits */
+#include <unordered_set> /* std::unordered_set */
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+namespace rcppsimdjson {
+namespace aggregate {
+
+
+/**
+ * @brief Running reductions over JSON values, which never materialize an R object.
+ *
+ * `count` includes every non-`null` value, `sum`, `min`, `max`, and `mean` only numbers, and
+ * `n_distinct` every non-`null` value, compared by their minified JSON text.
+ */
+struct Accumulator {
+    R_xlen_t                        count          = 0;
+    R_xlen_t                        n_numbers      = 0;
+    double                          sum            = 0;
+    double                          min            = std::numeric_limits<double>::infinity();
+    double                          max            = -std::numeric_limits<double>::infinity();
+    bool                            track_distinct = false;
+    std::unordered_set<std::string> distinct       = std::unordered_set<std::string>();
+
+    void add(simdjson::dom::element element) {
+        switch (element.type()) {
+            case simdjson::dom::element_type::NULL_VALUE:
+                return;
+
+            case simdjson::dom::element_type::INT64:
+            case simdjson::dom::element_type::UINT64:
+            case simdjson::dom::element_type::DOUBLE: {
+                const auto x = double(element);
+                sum += x;
+                min = std::min(min, x);
+                max = std::max(max, x);
+                n_numbers++;
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        count++;
+        if (track_distinct) {
+            distinct.insert(simdjson::minify(element));
+        }
+    }
+
+    void merge(Accumulator&& other) {
+        count += other.count;
+        n_numbers += other.n_numbers;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        distinct.merge(other.distinct);
+    }
+
+    [[nodiscard]] auto result(const std::string_view fun) const noexcept -> double {
+        if (fun == "count") {
+            return static_cast<double>(count);
+        }
+        if (fun == "n_distinct") {
+            return static_cast<double>(std::size(distinct));
+        }
+        if (fun == "sum") {
+            return sum;
+        }
+        if (n_numbers == 0) { // `min`, `max`, and `mean` are undefined without any numbers
+            return NA_REAL;
+        }
+        if (fun == "min") {
+            return min;
+        }
+        if (fun == "max") {
+            return max;
+        }
+        return sum / static_cast<double>(n_numbers); // "mean"
+    }
+};
+
+
+/**
+ * @brief Reduce every value that `tokens` reaches in each of `docs`.
+ *
+ * Documents are parsed and reduced in parallel by up to `n_threads` OpenMP threads, each with its
+ * own parser and Accumulator, which are merged at the end. R's API is never touched in the
+ * parallel region.
+ *
+ * @param docs JSON documents; std::nullopt (`NA`) documents are skipped.
+ *
+ * @param first_error  Set to the index of the first document that fails to parse, if any.
+ */
+inline auto reduce(const std::vector<std::optional<std::string_view>>& docs,
+                   const std::vector<pointer::Token>&                  tokens,
+                   const bool                                          track_distinct,
+                   const int                                           n_threads,
+                   std::optional<R_xlen_t>&                            first_error) -> Accumulator {
+
+    const auto n_docs    = r_length(docs);
+    const auto n_workers = std::max(1, n_threads);
+    auto       partials  = std::vector<Accumulator>(n_workers);
+    auto       errors    = std::vector<R_xlen_t>(n_workers, n_docs);
+    for (auto& partial : partials) {
+        partial.track_distinct = track_distinct;
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_workers)
+#endif
+    {
+#ifdef _OPENMP
+        const auto worker = omp_get_thread_num();
+#else
+        const auto worker = 0;
+#endif
+        simdjson::dom::parser parser;
+
+        auto add = [&partial = partials[worker]](simdjson::dom::element element) {
+            partial.add(element);
+        };
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+        for (R_xlen_t i = 0; i < n_docs; ++i) {
+            simdjson::dom::element parsed;
+            if (!docs[i]) {
+                continue;
+            }
+            if (parser.parse(*docs[i]).get(parsed) != simdjson::SUCCESS) {
+                errors[worker] = std::min(errors[worker], i);
+                continue;
+            }
+            pointer::for_each_match(parsed, tokens, 0, add);
+        }
+    }
+
+    if (const auto error = *std::min_element(std::begin(errors), std::end(errors));
+        error != n_docs) {
+        first_error = error;
+    }
+
+    auto out = std::move(partials.front());
+    for (auto it = std::next(std::begin(partials)); it != std::end(partials); ++it) {
+        out.merge(std::move(*it));
+    }
+
+    return out;
+}
+
+
+} // namespace aggregate
+} // namespace rcppsimdjson
+
+
+#endif
@@ -0,0 +1,772 @@
+#ifndef RCPPSIMDJSON_ARROW_HPP
+#define RCPPSIMDJSON_ARROW_HPP
+
+
+#include "deserialize.hpp"
+
+#include <algorithm>     /* std::max, std::min */
+#include <array>         /* std::array */
+#include <cstdint>       /* int32_t, int64_t, uint8_t, uint64_t */
+#include <cstring>       /* std::memcpy */
+#include <deque>         /* std::deque */
+#include <limits>        /* std::numeric_limits */
+#include <memory>        /* std::unique_ptr */
+#include <optional>      /* std::optional */
+#include <string>        /* std::string */
+#include <string_view>   /* std::string_view */
+#include <type_traits>   /* std::integral_constant */
+#include <unordered_map> /* std::unordered_map */
+#include <vector>        /* std::vector */
+
+
+/* The Arrow C Data Interface, as given by its specification (and defined the same way by arrow,
+ * nanoarrow, duckdb, ...): https://arrow.apache.org/docs/format/CDataInterface.html */
+#ifndef ARROW_C_DATA_INTERFACE
+#    define ARROW_C_DATA_INTERFACE
+
+#    define ARROW_FLAG_DICTIONARY_ORDERED 1
+#    define ARROW_FLAG_NULLABLE 2
+#    define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char*          format;
+    const char*          name;
+    const char*          metadata;
+    int64_t              flags;
+    int64_t              n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema*  dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t             length;
+    int64_t             null_count;
+    int64_t             offset;
+    int64_t             n_buffers;
+    int64_t             n_children;
+    const void**        buffers;
+    struct ArrowArray** children;
+    struct ArrowArray*  dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+
+namespace rcppsimdjson {
+namespace arrow {
+
+
+/**
+ * @brief A growable buffer, allocated as 64-bit words so that it's aligned for any of the types it
+ * holds. Its data is never NULL, even when it's empty.
+ */
+class Buffer {
+    std::vector<uint64_t> words   = std::vector<uint64_t>(1);
+    std::size_t           n_bytes = 0;
+
+  public:
+    [[nodiscard]] auto data() noexcept -> char* { return reinterpret_cast<char*>(words.data()); }
+    [[nodiscard]] auto data() const noexcept -> const char* {
+        return reinterpret_cast<const char*>(words.data());
+    }
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return n_bytes; }
+
+    inline auto append(const void* bytes, const std::size_t n) -> void {
+        if (const auto n_words = (n_bytes + n + 7) / 8; n_words > std::size(words)) {
+            words.resize(std::max(n_words, 2 * std::size(words)));
+        }
+        std::memcpy(data() + n_bytes, bytes, n);
+        n_bytes += n;
+    }
+
+    template <typename T>
+    inline auto append(const T x) -> void {
+        append(&x, sizeof(T));
+    }
+
+    /**
+     * @brief Set bit `i` of a bitmap to `bit`, where `i` is the number of bits already appended.
+     */
+    inline auto append_bit(const bool bit, const int64_t i) -> void {
+        if (i % 8 == 0) {
+            append(uint8_t(0));
+        }
+        if (bit) {
+            data()[i / 8] |= char(1U << (i % 8));
+        }
+    }
+
+    /* keeps its capacity, for the next batch */
+    inline auto clear() noexcept -> void { n_bytes = 0; }
+    inline auto shrink(const std::size_t n) noexcept -> void { n_bytes = std::min(n, n_bytes); }
+};
+
+
+/**
+ * @brief The Arrow type of a column.
+ *
+ * `utf8` is text of JSON strings (and numbers and Booleans, formatted as they are in R), whereas
+ * `json` is the minified JSON of values that mix containers with other types.
+ */
+enum class Kind { null, boolean, int32, int64, uint64, float64, utf8, json, struct_, list };
+
+
+/**
+ * @brief The diagnosis of a column (and, recursively, of its fields or items), filled in one value
+ * at a time by `add()` and resolved to a Kind once every value has been seen.
+ *
+ * Each column is diagnosed by Type_Doctor, with the same `type_policy` as `fparse()`, and becomes:
+ *  - `null` ("n") if every value is `null` or missing.
+ *  - `bool` ("b"), `int32` ("i"), `int64` ("l"), `uint64` ("L"), or `double` ("g") if its values
+ *    vectorize to Type_Doctor::common_R_type(); `int64` needs no integer64 class. Anything
+ *    unsigned that isn't only `uint64`s is a string, as it is in R.
+ *  - `utf8` ("u", or "U" with 64-bit offsets if it doesn't fit in 2GB) for strings.
+ *  - `struct` ("+s") if every value is an object, with a field per key in order of first
+ *    appearance; `list` ("+l", or "+L") if every value is an array, whose items are a column.
+ *  - otherwise (e.g. values that are objects in some rows and numbers in others), `utf8` of each
+ *    value's minified JSON.
+ *
+ * Keys are copied, so a Field_Type can outlive the documents it has seen.
+ */
+template <deserialize::Type_Policy type_policy>
+class Field_Type {
+    deserialize::Type_Doctor<type_policy, utils::Int64_R_Type::Double> type_doc =
+        deserialize::Type_Doctor<type_policy, utils::Int64_R_Type::Double>();
+
+  public:
+    Kind kind = Kind::null;
+
+    /* `names` is a deque so that the keys of `index`, which view its strings, stay put */
+    std::deque<std::string>                           names  = std::deque<std::string>();
+    std::vector<Field_Type>                           fields = std::vector<Field_Type>();
+    std::unordered_map<std::string_view, std::size_t> index =
+        std::unordered_map<std::string_view, std::size_t>();
+    std::unique_ptr<Field_Type> item = nullptr;
+
+    inline auto add(simdjson::dom::element value) -> void;
+    inline auto resolve() -> void;
+};
+
+
+template <deserialize::Type_Policy type_policy>
+inline auto Field_Type<type_policy>::add(simdjson::dom::element value) -> void {
+    type_doc.add_element(value);
+
+    if (simdjson::dom::object object; value.get(object) == simdjson::SUCCESS) {
+        for (auto [key, field] : object) {
+            auto it = index.find(key);
+            if (it == std::end(index)) {
+                names.emplace_back(key);
+                it = index.emplace(names.back(), std::size(fields)).first;
+                fields.emplace_back();
+            }
+            fields[it->second].add(field);
+        }
+
+    } else if (simdjson::dom::array array; value.get(array) == simdjson::SUCCESS) {
+        if (!item) {
+            item = std::make_unique<Field_Type>();
+        }
+        for (auto element : array) {
+            item->add(element);
+        }
+    }
+}
+
+
+template <deserialize::Type_Policy type_policy>
+inline auto Field_Type<type_policy>::resolve() -> void {
+    using simdjson::dom::element_type;
+
+    if (type_doc.is_homogeneous() && type_doc.common_element_type() == element_type::OBJECT) {
+        kind = Kind::struct_;
+    } else if (type_doc.is_homogeneous() && type_doc.common_element_type() == element_type::ARRAY) {
+        kind = Kind::list;
+    } else if (!type_doc.is_vectorizable() && type_doc.common_R_type() != rcpp_T::null) {
+        kind = Kind::json;
+    } else {
+        switch (type_doc.common_R_type()) {
+            case rcpp_T::chr:
+                kind = Kind::utf8;
+                break;
+            case rcpp_T::u64:
+                kind = type_doc.is_homogeneous() ? Kind::uint64 : Kind::utf8;
+                break;
+            case rcpp_T::dbl:
+                kind = Kind::float64;
+                break;
+            case rcpp_T::i64:
+                kind = Kind::int64;
+                break;
+            case rcpp_T::i32:
+                kind = Kind::int32;
+                break;
+            case rcpp_T::lgl:
+                kind = Kind::boolean;
+                break;
+            default:
+                kind = Kind::null;
+                break;
+        }
+    }
+
+    if (kind == Kind::struct_) {
+        for (auto& field : fields) {
+            field.resolve();
+        }
+    } else if (kind == Kind::list) {
+        item->resolve();
+    }
+}
+
+
+/**
+ * @brief The values of a column of a resolved Field_Type, appended one row at a time into Arrow's
+ * buffers.
+ *
+ * Offsets are kept as 64-bit integers until `finish()`, which narrows them to 32 bits if they fit.
+ * A Column can be `clear()`ed and refilled, reusing its buffers, which is how batches are built.
+ */
+template <deserialize::Type_Policy type_policy>
+class Column {
+    static inline auto append_text(simdjson::dom::element value, Buffer& text) -> void;
+
+  public:
+    const Field_Type<type_policy>* type;
+
+    int64_t             length        = 0;
+    int64_t             null_count    = 0;
+    bool                large_offsets = false;
+    Buffer              validity      = Buffer();
+    Buffer              offsets       = Buffer();
+    Buffer              values        = Buffer();
+    std::vector<Column> children      = std::vector<Column>();
+
+    explicit Column(const Field_Type<type_policy>& type);
+
+    /**
+     * @brief Append `value`, or a null if it's std::nullopt.
+     */
+    inline auto append(std::optional<simdjson::dom::element> value) -> void;
+
+    inline auto finish() -> void;
+    inline auto clear() -> void;
+
+    /**
+     * @brief The Arrow format string of the column, once it's `finish()`ed.
+     */
+    [[nodiscard]] inline auto format() const -> const char*;
+
+    /**
+     * @brief The column's buffers in Arrow's order, starting with its validity bitmap (none for
+     * `null` columns).
+     */
+    [[nodiscard]] inline auto buffers() -> std::vector<Buffer*>;
+};
+
+
+template <deserialize::Type_Policy type_policy>
+inline Column<type_policy>::Column(const Field_Type<type_policy>& type) : type(&type) {
+    if (type.kind == Kind::struct_) {
+        children.reserve(std::size(type.fields));
+        for (const auto& field : type.fields) {
+            children.emplace_back(field);
+        }
+    } else if (type.kind == Kind::list) {
+        children.emplace_back(*type.item);
+    }
+    clear();
+}
+
+
+template <deserialize::Type_Policy type_policy>
+inline auto Column<type_policy>::append_text(simdjson::dom::element value, Buffer& text) -> void {
+    std::array<char, utils::NUMBER_BUFFER_SIZE> number;
+    const auto append_number = [&number, &text](const auto x) {
+        const auto end = utils::format_number(number.data(), number.data() + number.size(), x);
+        text.append(number.data(), std::size_t(end - number.data()));
+    };
+
+    switch (value.type()) {
+        case simdjson::dom::element_type::STRING: {
+            const auto string = std::string_view(value);
+            text.append(string.data(), std::size(string));
+            break;
+        }
+        case simdjson::dom::element_type::DOUBLE:
+            append_number(double(value));
+            break;
+        case simdjson::dom::element_type::INT64:
+            append_number(int64_t(value));
+            break;
+        case simdjson::dom::element_type::UINT64:
+            append_number(uint64_t(value));
+            break;
+        case simdjson::dom::element_type::BOOL:
+            bool(value) ? text.append("TRUE", 4) : text.append("FALSE", 5);
+            break;
+        default:
+            break; // # nocov
+    }
+}
+
+
+template <deserialize::Type_Policy type_policy>
+inline auto Column<type_policy>::append(std::optional<simdjson::dom::element> value) -> void {
+    const auto is_valid = value && !value->is_null();
+    validity.append_bit(is_valid, length);
+    null_count += !is_valid;
+
+    switch (type->kind) {
+        case Kind::null:
+            break;
+
+        case Kind::boolean:
+            values.append_bit(is_valid && bool(*value), length);
+            break;
+
+        case Kind::int32:
+            values.append<int32_t>(
+                is_valid ? deserialize::get_scalar_dispatch<INTSXP>(*value) : int32_t(0));
+            break;
+
+        case Kind::int64:
+            values.append<int64_t>(!is_valid           ? int64_t(0)
+                                   : value->is_bool() ? int64_t(bool(*value))
+                                                      : int64_t(*value));
+            break;
+
+        case Kind::uint64:
+            values.append<uint64_t>(is_valid ? uint64_t(*value) : uint64_t(0));
+            break;
+
+        case Kind::float64:
+            values.append<double>(is_valid ? deserialize::get_scalar_dispatch<REALSXP>(*value)
+                                           : 0.0);
+            break;
+
+        case Kind::utf8:
+            if (is_valid) {
+                append_text(*value, values);
+            }
+            offsets.append<int64_t>(int64_t(values.size()));
+            break;
+
+        case Kind::json:
+            if (is_valid) {
+                const auto minified = simdjson::minify(*value);
+                values.append(minified.data(), std::size(minified));
+            }
+            offsets.append<int64_t>(int64_t(values.size()));
+            break;
+
+        case Kind::struct_:
+            /* each object is visited once, its values dealt out to the fields of its keys... */
+            if (simdjson::dom::object object; is_valid && value->get(object) == simdjson::SUCCESS) {
+                for (auto [key, field] : object) {
+                    if (const auto it = type->index.find(key); it != std::end(type->index)) {
+                        /* ... the first of any duplicated keys winning */
+                        if (auto& child = children[it->second]; child.length == length) {
+                            child.append(field);
+                        }
+                    }
+                }
+            }
+            for (auto& child : children) {
+                if (child.length == length) {
+                    child.append(std::nullopt);
+                }
+            }
+            break;
+
+        case Kind::list:
+            if (simdjson::dom::array array; is_valid && value->get(array) == simdjson::SUCCESS) {
+                for (auto element : array) {
+                    children.front().append(element);
+                }
+            }
+            offsets.append<int64_t>(children.front().length);
+            break;
+    }
+
+    ++length;
+}
+
+
+template <deserialize::Type_Policy type_policy>
+inline auto Column<type_policy>::finish() -> void {
+    const auto has_offsets =
+        type->kind == Kind::utf8 || type->kind == Kind::json || type->kind == Kind::list;
+    if (has_offsets) {
+        const auto wide = reinterpret_cast<const int64_t*>(offsets.data());
+        large_offsets   = wide[length] > int64_t(std::numeric_limits<int32_t>::max());
+        if (!large_offsets) {
+            /* narrowed in place: each int32_t is written over the start of its own int64_t */
+            auto narrow = reinterpret_cast<int32_t*>(offsets.data());
+            for (int64_t i = 0; i <= length; ++i) {
+                narrow[i] = int32_t(wide[i]);
+            }
+            offsets.shrink(sizeof(int32_t) * std::size_t(length + 1));
+        }
+    }
+
+    for (auto& child : children) {
+        child.finish();
+    }
+}
+
+
+template <deserialize::Type_Policy type_policy>
+inline auto Column<type_policy>::clear() -> void {
+    length     = 0;
+    null_count = 0;
+    validity.clear();
+    offsets.clear();
+    values.clear();
+    if (type->kind == Kind::utf8 || type->kind == Kind::json || type->kind == Kind::list) {
+        offsets.append(int64_t(0));
+    }
+    for (auto& child : children) {
+        child.clear();
+    }
+}
+
+
+template <deserialize::Type_Policy type_policy>
+inline auto Column<type_policy>::format() const -> const char* {
+    switch (type->kind) {
+        case Kind::null:
+            return "n";
+        case Kind::boolean:
+            return "b";
+        case Kind::int32:
+            return "i";
+        case Kind::int64:
+            return "l";
+        case Kind::uint64:
+            return "L";
+        case Kind::float64:
+            return "g";
+        case Kind::utf8:
+        case Kind::json:
+            return large_offsets ? "U" : "u";
+        case Kind::struct_:
+            return "+s";
+        case Kind::list:
+            return large_offsets ? "+L" : "+l";
+    }
+    return "n"; // # nocov
+}
+
+
+template <deserialize::Type_Policy type_policy>
+inline auto Column<type_policy>::buffers() -> std::vector<Buffer*> {
+    switch (type->kind) {
+        case Kind::null:
+            return {};
+        case Kind::struct_:
+            return {&validity};
+        case Kind::list:
+            return {&validity, &offsets};
+        case Kind::utf8:
+        case Kind::json:
+            return {&validity, &offsets, &values};
+        default:
+            return {&validity, &values};
+    }
+}
+
+
+/**
+ * @brief Call `fun(type_policy)` with `type_policy` as a `std::integral_constant`.
+ */
+template <typename fun_T>
+inline auto dispatch_type_policy(const deserialize::Type_Policy type_policy, fun_T&& fun) {
+    using deserialize::Type_Policy;
+
+    switch (type_policy) {
+        case Type_Policy::anything_goes:
+            break;
+
+        case Type_Policy::ints_as_dbls:
+            return fun(std::integral_constant<Type_Policy, Type_Policy::ints_as_dbls>());
+
+        case Type_Policy::strict:
+            return fun(std::integral_constant<Type_Policy, Type_Policy::strict>());
+    }
+
+    return fun(std::integral_constant<Type_Policy, Type_Policy::anything_goes>());
+}
+
+
+/**
+ * @brief Everything an exported ArrowSchema points to, freed by release_schema().
+ */
+struct Schema_Data {
+    std::string                               format;
+    std::string                               name;
+    std::vector<std::unique_ptr<ArrowSchema>> owned_children;
+    std::vector<ArrowSchema*>                 children;
+};
+
+/**
+ * @brief Everything an exported ArrowArray points to (the buffers of its Column, moved into
+ * `storage`), freed by release_array().
+ */
+struct Array_Data {
+    std::vector<Buffer>                      storage;
+    std::vector<const void*>                 buffers;
+    std::vector<std::unique_ptr<ArrowArray>> owned_children;
+    std::vector<ArrowArray*>                 children;
+};
+
+
+/* Per the C Data Interface, releasing a parent releases its children (unless a consumer has
+ * already moved and released them), then marks it released. */
+inline void release_schema(ArrowSchema* schema) {
+    auto data = static_cast<Schema_Data*>(schema->private_data);
+    for (auto child : data->children) {
+        if (child->release) {
+            child->release(child);
+        }
+    }
+    delete data;
+    schema->release = nullptr;
+}
+
+inline void release_array(ArrowArray* array) {
+    auto data = static_cast<Array_Data*>(array->private_data);
+    for (auto child : data->children) {
+        if (child->release) {
+            child->release(child);
+        }
+    }
+    delete data;
+    array->release = nullptr;
+}
+
+
+/**
+ * @brief Export a `finish()`ed `column` into released or uninitialized `schema` and `array`,
+ * moving its buffers into them.
+ */
+template <deserialize::Type_Policy type_policy>
+inline auto export_column(Column<type_policy>& column,
+                          std::string          name,
+                          ArrowSchema*         schema,
+                          ArrowArray*          array) -> void {
+    auto schema_data = new Schema_Data{column.format(), std::move(name), {}, {}};
+    auto array_data  = new Array_Data();
+
+    const auto buffers = column.buffers();
+    array_data->storage.reserve(std::size(buffers));
+    for (auto buffer : buffers) {
+        array_data->storage.push_back(std::move(*buffer));
+        array_data->buffers.push_back(array_data->storage.back().data());
+    }
+    if (!std::empty(buffers) && column.null_count == 0) {
+        array_data->buffers.front() = nullptr; /* no nulls, no validity bitmap */
+    }
+
+    for (std::size_t i = 0; i < std::size(column.children); ++i) {
+        schema_data->owned_children.push_back(std::make_unique<ArrowSchema>());
+        array_data->owned_children.push_back(std::make_unique<ArrowArray>());
+        schema_data->children.push_back(schema_data->owned_children.back().get());
+        array_data->children.push_back(array_data->owned_children.back().get());
+
+        export_column(column.children[i],
+                      column.type->kind == Kind::list ? std::string("item")
+                                                      : column.type->names[i],
+                      schema_data->children.back(),
+                      array_data->children.back());
+    }
+
+    *schema = ArrowSchema{schema_data->format.c_str(),
+                          schema_data->name.c_str(),
+                          nullptr,
+                          ARROW_FLAG_NULLABLE,
+                          int64_t(std::size(schema_data->children)),
+                          schema_data->children.data(),
+                          nullptr,
+                          &release_schema,
+                          schema_data};
+    *array  = ArrowArray{column.length,
+                        column.null_count,
+                        0,
+                        int64_t(std::size(array_data->buffers)),
+                        int64_t(std::size(array_data->children)),
+                        array_data->buffers.data(),
+                        array_data->children.data(),
+                        nullptr,
+                        &release_array,
+                        array_data};
+}
+
+
+/* Like nanoarrow, exported structs live in external pointers classed "nanoarrow_schema" and
+ * "nanoarrow_array", which release them (if their consumer hasn't) when garbage collected. */
+inline void finalize_schema_xptr(SEXP xptr) {
+    if (auto schema = static_cast<ArrowSchema*>(R_ExternalPtrAddr(xptr))) {
+        if (schema->release) {
+            schema->release(schema);
+        }
+        delete schema;
+        R_ClearExternalPtr(xptr);
+    }
+}
+
+inline void finalize_array_xptr(SEXP xptr) {
+    if (auto array = static_cast<ArrowArray*>(R_ExternalPtrAddr(xptr))) {
+        if (array->release) {
+            array->release(array);
+        }
+        delete array;
+        R_ClearExternalPtr(xptr);
+    }
+}
+
+
+/**
+ * @brief Export `rows` (a simdjson::dom::array, or any other range of elements) as a
+ * "nanoarrow_array" whose tag is its "nanoarrow_schema".
+ *
+ * Rows of records are a `struct` column of those records, which arrow, duckdb, polars, etc. import
+ * as a record batch. The rows are visited twice: once to diagnose them, then to fill their Column.
+ */
+template <typename rows_T>
+inline auto export_rows(const rows_T& rows, const deserialize::Type_Policy type_policy) -> SEXP {
+    auto schema = std::make_unique<ArrowSchema>();
+    auto array  = std::make_unique<ArrowArray>();
+
+    dispatch_type_policy(type_policy, [&](auto policy) {
+        constexpr auto policy_v = decltype(policy)::value;
+
+        auto type = Field_Type<policy_v>();
+        for (auto row : rows) {
+            type.add(row);
+        }
+        type.resolve();
+
+        auto column = Column<policy_v>(type);
+        for (auto row : rows) {
+            column.append(row);
+        }
+        column.finish();
+
+        export_column(column, std::string(), schema.get(), array.get());
+    });
+
+    auto schema_xptr = Rcpp::RObject(R_MakeExternalPtr(schema.release(), R_NilValue, R_NilValue));
+    R_RegisterCFinalizerEx(schema_xptr, &finalize_schema_xptr, TRUE);
+    schema_xptr.attr("class") = "nanoarrow_schema";
+
+    auto array_xptr = Rcpp::RObject(R_MakeExternalPtr(array.release(), schema_xptr, R_NilValue));
+    R_RegisterCFinalizerEx(array_xptr, &finalize_array_xptr, TRUE);
+    array_xptr.attr("class") = "nanoarrow_array";
+
+    return array_xptr;
+}
+
+
+/**
+ * @brief Export a parsed (and queried) document with export_rows().
+ *
+ * An array's elements are its rows, and anything else is a single row.
+ */
+inline auto export_document(simdjson::dom::element         parsed,
+                            const deserialize::Type_Policy type_policy) -> SEXP {
+    if (simdjson::dom::array rows; parsed.get(rows) == simdjson::SUCCESS) {
+        return export_rows(rows, type_policy);
+    }
+    return export_rows(std::array<simdjson::dom::element, 1>{parsed}, type_policy);
+}
+
+
+/**
+ * @brief Export each of `json` to Arrow, after following `query` (R_NilValue or a single JSON
+ * Pointer, possibly extended) into it.
+ *
+ * Every value an extended `query` with wildcards or slices matches is a row, as if they were the
+ * elements of an array. Inputs that are `NA`, fail to parse (if `parse_error_ok`), or in which
+ * `query` finds nothing (if `query_error_ok`) are `NULL`. Values are never turned into R vectors.
+ */
+template <typename json_T, bool is_file>
+inline auto export_json(const json_T&                  json,
+                        SEXP                           query,
+                        const bool                     parse_error_ok,
+                        const bool                     query_error_ok,
+                        const deserialize::Type_Policy type_policy) -> SEXP {
+    const auto n   = R_xlen_t(std::size(json));
+    auto       out = Rcpp::List(n);
+
+    /* an extended pointer without wildcards or slices is just the plain pointer after its `$` */
+    auto path    = std::string_view();
+    auto fan_out = std::optional<std::vector<pointer::Token>>();
+    if (!Rf_isNull(query)) {
+        path = CHAR(STRING_ELT(query, 0));
+    }
+    if (pointer::is_extended(path)) {
+        if (auto tokens = pointer::tokenize(path); tokens && pointer::is_fan_out(*tokens)) {
+            fan_out = std::move(tokens);
+        }
+        path.remove_prefix(1);
+    }
+
+    simdjson::dom::parser parser;
+    for (R_xlen_t i = 0; i < n; ++i) {
+        if (utils::is_na_string(json[i])) {
+            continue;
+        }
+
+        simdjson::dom::element parsed;
+        if (const auto error =
+                deserialize::parse<decltype(json[i]), is_file>(parser, json[i]).get(parsed);
+            error != simdjson::SUCCESS) {
+            if (parse_error_ok) {
+                continue;
+            }
+            Rcpp::stop(simdjson::error_message(error));
+        }
+
+        if (fan_out) {
+            auto matches = std::vector<simdjson::dom::element>();
+            auto collect = [&matches](simdjson::dom::element match) { matches.push_back(match); };
+            pointer::for_each_match(parsed, *fan_out, 0, collect);
+            out[i] = export_rows(matches, type_policy);
+            continue;
+        }
+
+        if (!Rf_isNull(query)) {
+            if (const auto error = parsed.at_pointer(path).get(parsed);
+                error != simdjson::SUCCESS) {
+                if (query_error_ok) {
+                    continue;
+                }
+                Rcpp::stop(simdjson::error_message(error));
+            }
+        }
+
+        out[i] = export_document(parsed, type_policy);
+    }
+
+    return out;
+}
+
+
+} // namespace arrow
+} // namespace rcppsimdjson
+
+
+#endif
@@ -0,0 +1,491 @@
+#ifndef RCPPSIMDJSON_ARROW_IPC_HPP
+#define RCPPSIMDJSON_ARROW_IPC_HPP
+
+
+#include "arrow.hpp"
+#include "records.hpp"
+
+#include <fstream> /* std::ofstream */
+#include <string>  /* std::string */
+#include <vector>  /* std::vector */
+
+
+namespace rcppsimdjson {
+namespace arrow {
+namespace ipc {
+
+
+/**
+ * @brief Just enough of a FlatBuffers builder to write Arrow's IPC metadata (Schema.fbs,
+ * Message.fbs, and File.fbs) without depending on flatc or its runtime.
+ *
+ * Like FlatBuffers' own, it builds back to front: everything is prepended, and an object is
+ * referred to by its Offset, the number of bytes from it to the end of the buffer. Children are
+ * therefore built (and their Offsets kept) before the tables that refer to them.
+ */
+class Flatbuffer {
+    std::vector<uint8_t> buffer      = std::vector<uint8_t>(1024);
+    std::size_t          n           = 0; /* bytes used, at the end of `buffer` */
+    std::size_t          max_align   = 1;
+    std::size_t          table_start = 0;
+    std::vector<std::pair<uint16_t, uint32_t>> table_fields =
+        std::vector<std::pair<uint16_t, uint32_t>>();
+
+    inline auto reserve(const std::size_t extra) -> void {
+        if (n + extra > std::size(buffer)) {
+            auto grown = std::vector<uint8_t>(std::max(2 * std::size(buffer), n + extra));
+            std::copy(std::end(buffer) - n, std::end(buffer), std::end(grown) - n);
+            buffer.swap(grown);
+        }
+    }
+
+    inline auto prepend(const void* bytes, const std::size_t size) -> void {
+        if (size > 0) {
+            reserve(size);
+            n += size;
+            std::memcpy(&buffer[std::size(buffer) - n], bytes, size);
+        }
+    }
+
+    inline auto pad(const std::size_t size) -> void {
+        reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            buffer[std::size(buffer) - ++n] = 0;
+        }
+    }
+
+    /* pad so that, after another `extra` bytes, what's been built is aligned to `size` */
+    inline auto align(const std::size_t size, const std::size_t extra = 0) -> void {
+        max_align = std::max(max_align, size);
+        pad((size - (n + extra) % size) % size);
+    }
+
+    template <typename T>
+    inline auto push(const T x) -> void {
+        align(sizeof(T));
+        prepend(&x, sizeof(T));
+    }
+
+    inline auto push_offset(const uint32_t offset) -> void {
+        align(sizeof(uint32_t));
+        const auto relative = uint32_t(n + sizeof(uint32_t) - offset);
+        prepend(&relative, sizeof(uint32_t));
+    }
+
+  public:
+    using Offset = uint32_t;
+
+    inline auto string(const std::string_view string) -> Offset {
+        align(sizeof(uint32_t), std::size(string) + 1);
+        pad(1);
+        prepend(string.data(), std::size(string));
+        push(uint32_t(std::size(string)));
+        return Offset(n);
+    }
+
+    inline auto vector_of_offsets(const std::vector<Offset>& offsets) -> Offset {
+        align(sizeof(uint32_t), sizeof(uint32_t) * std::size(offsets));
+        for (auto it = std::rbegin(offsets); it != std::rend(offsets); ++it) {
+            push_offset(*it);
+        }
+        push(uint32_t(std::size(offsets)));
+        return Offset(n);
+    }
+
+    /**
+     * @param structs  Structs laid out as FlatBuffers lays them out, aligned to 8 bytes.
+     */
+    template <typename struct_T>
+    inline auto vector_of_structs(const std::vector<struct_T>& structs) -> Offset {
+        const auto size = sizeof(struct_T) * std::size(structs);
+        align(sizeof(uint32_t), size);
+        align(sizeof(int64_t), size);
+        prepend(structs.data(), size);
+        push(uint32_t(std::size(structs)));
+        return Offset(n);
+    }
+
+    inline auto start_table() -> void {
+        table_fields.clear();
+        table_start = n;
+    }
+
+    template <typename T>
+    inline auto add_scalar(const uint16_t id, const T x) -> void {
+        push(x);
+        table_fields.emplace_back(id, uint32_t(n));
+    }
+
+    inline auto add_offset(const uint16_t id, const Offset offset) -> void {
+        push_offset(offset);
+        table_fields.emplace_back(id, uint32_t(n));
+    }
+
+    inline auto end_table() -> Offset {
+        push(int32_t(0)); /* the offset to the vtable, filled in below */
+        const auto object = n;
+
+        auto n_fields = uint16_t(0);
+        for (const auto& [id, offset] : table_fields) {
+            n_fields = std::max(n_fields, uint16_t(id + 1));
+        }
+        auto vtable = std::vector<uint16_t>(2 + n_fields);
+        vtable[0]   = uint16_t(sizeof(uint16_t) * std::size(vtable));
+        vtable[1]   = uint16_t(object - table_start);
+        for (const auto& [id, offset] : table_fields) {
+            vtable[2 + id] = uint16_t(object - offset);
+        }
+        for (auto it = std::rbegin(vtable); it != std::rend(vtable); ++it) {
+            push(*it);
+        }
+
+        const auto to_vtable = int32_t(n - object);
+        std::memcpy(&buffer[std::size(buffer) - object], &to_vtable, sizeof(int32_t));
+        return Offset(object);
+    }
+
+    /**
+     * @brief Finish the buffer with `root`, padded to 8 bytes, and return its bytes.
+     */
+    inline auto finish(const Offset root) -> std::string_view {
+        align(std::max(max_align, sizeof(int64_t)), sizeof(uint32_t));
+        push_offset(root);
+        return std::string_view(reinterpret_cast<const char*>(&buffer[std::size(buffer) - n]), n);
+    }
+};
+
+
+/* FlatBuffers structs, as laid out in Arrow's IPC metadata */
+struct Field_Node {
+    int64_t length;
+    int64_t null_count;
+};
+
+struct Body_Buffer {
+    int64_t offset;
+    int64_t length;
+};
+
+struct Block {
+    int64_t offset;
+    int32_t meta_data_length;
+    int32_t padding;
+    int64_t body_length;
+};
+
+
+/* Arrow's enum and union values */
+inline constexpr int16_t METADATA_V5         = 4;
+inline constexpr uint8_t HEADER_SCHEMA       = 1;
+inline constexpr uint8_t HEADER_RECORD_BATCH = 3;
+inline constexpr uint8_t TYPE_NULL           = 1;
+inline constexpr uint8_t TYPE_INT            = 2;
+inline constexpr uint8_t TYPE_FLOATING_POINT = 3;
+inline constexpr uint8_t TYPE_UTF8           = 5;
+inline constexpr uint8_t TYPE_BOOL           = 6;
+inline constexpr uint8_t TYPE_LIST           = 12;
+inline constexpr uint8_t TYPE_STRUCT         = 13;
+inline constexpr int16_t PRECISION_DOUBLE    = 2;
+
+
+/**
+ * @brief Add a Schema.fbs `Field` for `type`, and (first) those of its children.
+ */
+template <deserialize::Type_Policy type_policy>
+inline auto add_field(Flatbuffer&                    fb,
+                      const Field_Type<type_policy>& type,
+                      const std::string_view         name) -> Flatbuffer::Offset {
+    auto children = std::vector<Flatbuffer::Offset>();
+    if (type.kind == Kind::struct_) {
+        for (std::size_t i = 0; i < std::size(type.fields); ++i) {
+            children.push_back(add_field(fb, type.fields[i], type.names[i]));
+        }
+    } else if (type.kind == Kind::list) {
+        children.push_back(add_field(fb, *type.item, "item"));
+    }
+    const auto children_offset = fb.vector_of_offsets(children);
+
+    auto type_id = uint8_t();
+    fb.start_table();
+    switch (type.kind) {
+        case Kind::null:
+            type_id = TYPE_NULL;
+            break;
+        case Kind::boolean:
+            type_id = TYPE_BOOL;
+            break;
+        case Kind::int32:
+        case Kind::int64:
+        case Kind::uint64:
+            type_id = TYPE_INT;
+            fb.add_scalar(0, int32_t(type.kind == Kind::int32 ? 32 : 64)); /* bitWidth */
+            fb.add_scalar(1, uint8_t(type.kind != Kind::uint64));          /* is_signed */
+            break;
+        case Kind::float64:
+            type_id = TYPE_FLOATING_POINT;
+            fb.add_scalar(0, PRECISION_DOUBLE); /* precision */
+            break;
+        case Kind::utf8:
+        case Kind::json:
+            type_id = TYPE_UTF8;
+            break;
+        case Kind::struct_:
+            type_id = TYPE_STRUCT;
+            break;
+        case Kind::list:
+            type_id = TYPE_LIST;
+            break;
+    }
+    const auto type_offset = fb.end_table();
+    const auto name_offset = fb.string(name);
+
+    fb.start_table();
+    fb.add_offset(0, name_offset);     /* name */
+    fb.add_scalar(1, uint8_t(true));   /* nullable */
+    fb.add_scalar(2, type_id);         /* type_type */
+    fb.add_offset(3, type_offset);     /* type */
+    fb.add_offset(5, children_offset); /* children */
+    return fb.end_table();
+}
+
+
+/**
+ * @brief Add a Schema.fbs `Schema` whose fields are those of a record `type`.
+ */
+template <deserialize::Type_Policy type_policy>
+inline auto add_schema(Flatbuffer& fb, const Field_Type<type_policy>& type)
+    -> Flatbuffer::Offset {
+    auto fields = std::vector<Flatbuffer::Offset>();
+    for (std::size_t i = 0; i < std::size(type.fields); ++i) {
+        fields.push_back(add_field(fb, type.fields[i], type.names[i]));
+    }
+    const auto fields_offset = fb.vector_of_offsets(fields);
+
+    fb.start_table();
+    fb.add_scalar(0, int16_t(0)); /* endianness: Little */
+    fb.add_offset(1, fields_offset);
+    return fb.end_table();
+}
+
+
+/**
+ * @brief Writes record batches of a fixed schema as an Arrow IPC stream, or as an Arrow IPC
+ * (Feather V2) file, which is the same stream between magic numbers and followed by a footer.
+ *
+ * https://arrow.apache.org/docs/format/Columnar.html#serialization-and-interprocess-communication-ipc
+ */
+template <deserialize::Type_Policy type_policy>
+class Writer {
+    const Field_Type<type_policy>& type;
+    const bool                     is_file;
+    std::ofstream                  out;
+    std::string                    path;
+    int64_t                        position = 0;
+    std::vector<Block>             blocks   = std::vector<Block>();
+
+    inline auto write(const void* bytes, const std::size_t size) -> void {
+        out.write(static_cast<const char*>(bytes), std::streamsize(size));
+        if (!out) {
+            Rcpp::stop("Failed to write to '" + path + "'.");
+        }
+        position += int64_t(size);
+    }
+
+    inline auto write_padding(const std::size_t size) -> void {
+        static constexpr char zeros[8] = {0};
+        write(zeros, (8 - size % 8) % 8);
+    }
+
+    /**
+     * @brief Write an encapsulated message: a continuation marker, the size of its (padded)
+     * metadata, then the metadata itself. Returns the size of all three.
+     */
+    inline auto write_message(const std::string_view metadata) -> int32_t {
+        const auto size = int32_t(std::size(metadata) + (8 - std::size(metadata) % 8) % 8);
+        write(&CONTINUATION, sizeof(CONTINUATION));
+        write(&size, sizeof(size));
+        write(metadata.data(), std::size(metadata));
+        write_padding(std::size(metadata));
+        return int32_t(sizeof(CONTINUATION) + sizeof(size)) + size;
+    }
+
+    inline auto collect(Column<type_policy>&       column,
+                        std::vector<Field_Node>&   nodes,
+                        std::vector<Body_Buffer>&  buffers,
+                        std::vector<const Buffer*>& body,
+                        int64_t&                   body_length) -> void {
+        if (column.large_offsets) {
+            Rcpp::stop("A batch's column has more than 2GB of strings or items; use a smaller "
+                       "`batch_size=`.");
+        }
+        nodes.push_back(Field_Node{column.length, column.null_count});
+
+        const auto column_buffers = column.buffers();
+        for (std::size_t i = 0; i < std::size(column_buffers); ++i) {
+            /* no nulls, no validity bitmap */
+            const auto buffer = i == 0 && column.null_count == 0 ? nullptr : column_buffers[i];
+            const auto length = buffer ? int64_t(buffer->size()) : int64_t(0);
+            buffers.push_back(Body_Buffer{body_length, length});
+            body.push_back(buffer);
+            body_length += length + (8 - length % 8) % 8;
+        }
+
+        for (auto& child : column.children) {
+            collect(child, nodes, buffers, body, body_length);
+        }
+    }
+
+  public:
+    static inline constexpr uint32_t CONTINUATION = 0xFFFFFFFF;
+    static inline constexpr char     MAGIC[8]     = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+
+    Writer(const Field_Type<type_policy>& type, std::string path, const bool is_file)
+        : type(type), is_file(is_file), out(path, std::ios::binary), path(std::move(path)) {
+        if (!out) {
+            Rcpp::stop("Failed to open '" + this->path + "' for writing.");
+        }
+        if (is_file) {
+            write(MAGIC, sizeof(MAGIC));
+        }
+
+        auto fb            = Flatbuffer();
+        const auto schema  = add_schema(fb, type);
+        fb.start_table();
+        fb.add_scalar(0, METADATA_V5);   /* version */
+        fb.add_scalar(1, HEADER_SCHEMA); /* header_type */
+        fb.add_offset(2, schema);        /* header */
+        write_message(fb.finish(fb.end_table()));
+    }
+
+    /**
+     * @brief Write `records`, a `finish()`ed struct Column of a batch's records, as a record
+     * batch.
+     */
+    inline auto write_batch(Column<type_policy>& records) -> void {
+        auto nodes       = std::vector<Field_Node>();
+        auto buffers     = std::vector<Body_Buffer>();
+        auto body        = std::vector<const Buffer*>();
+        auto body_length = int64_t(0);
+        for (auto& child : records.children) {
+            collect(child, nodes, buffers, body, body_length);
+        }
+
+        auto       fb            = Flatbuffer();
+        const auto nodes_offset  = fb.vector_of_structs(nodes);
+        const auto buffer_offset = fb.vector_of_structs(buffers);
+        fb.start_table();
+        fb.add_scalar(0, records.length); /* length */
+        fb.add_offset(1, nodes_offset);   /* nodes */
+        fb.add_offset(2, buffer_offset);  /* buffers */
+        const auto batch = fb.end_table();
+
+        fb.start_table();
+        fb.add_scalar(0, METADATA_V5);         /* version */
+        fb.add_scalar(1, HEADER_RECORD_BATCH); /* header_type */
+        fb.add_offset(2, batch);               /* header */
+        fb.add_scalar(3, body_length);         /* bodyLength */
+
+        const auto offset = position;
+        const auto size   = write_message(fb.finish(fb.end_table()));
+        for (const auto buffer : body) {
+            if (buffer) {
+                write(buffer->data(), buffer->size());
+                write_padding(buffer->size());
+            }
+        }
+        blocks.push_back(Block{offset, size, 0, body_length});
+    }
+
+    /**
+     * @brief End the stream and, if writing a file, add its footer.
+     */
+    inline auto close() -> void {
+        const auto end_of_stream = uint32_t(0);
+        write(&CONTINUATION, sizeof(CONTINUATION));
+        write(&end_of_stream, sizeof(end_of_stream));
+
+        if (is_file) {
+            auto       fb           = Flatbuffer();
+            const auto schema       = add_schema(fb, type);
+            const auto dictionaries = fb.vector_of_structs(std::vector<Block>());
+            const auto batches      = fb.vector_of_structs(blocks);
+            fb.start_table();
+            fb.add_scalar(0, METADATA_V5); /* version */
+            fb.add_offset(1, schema);       /* schema */
+            fb.add_offset(2, dictionaries); /* dictionaries */
+            fb.add_offset(3, batches);      /* recordBatches */
+            const auto footer = fb.finish(fb.end_table());
+
+            const auto footer_size = int32_t(std::size(footer));
+            write(footer.data(), std::size(footer));
+            write(&footer_size, sizeof(footer_size));
+            write(MAGIC, 6);
+        }
+
+        out.close();
+        if (!out) {
+            Rcpp::stop("Failed to write to '" + path + "'."); // # nocov
+        }
+    }
+};
+
+
+/**
+ * @brief Convert the NDJSON file at `input` to an Arrow IPC stream (or file, if `is_file`) at
+ * `output`, in record batches of up to `batch_size` records.
+ *
+ * The records are streamed twice: first to diagnose the columns' types (so every batch shares one
+ * schema), then to fill a batch's columns, which are written and reused for the next batch. Each
+ * record must be an object (or `null`, a row of nulls).
+ *
+ * @return The number of records and of batches.
+ */
+inline auto convert_ndjson(const std::string&             input,
+                           const std::string&             output,
+                           const bool                     is_file,
+                           const int64_t                  batch_size,
+                           const deserialize::Type_Policy type_policy)
+    -> std::pair<int64_t, int64_t> {
+    return dispatch_type_policy(type_policy, [&](auto policy) {
+        constexpr auto policy_v = decltype(policy)::value;
+
+        auto type = Field_Type<policy_v>();
+        records::for_each_record(input,
+                                 [&type](simdjson::dom::element record) { type.add(record); });
+        type.resolve();
+        if (type.kind != Kind::struct_ && type.kind != Kind::null) {
+            Rcpp::stop("Every record of '" + input + "' must be a JSON object.");
+        }
+
+        auto writer    = Writer<policy_v>(type, output, is_file);
+        auto batch     = Column<policy_v>(type);
+        auto n_batches = int64_t(0);
+        const auto write_batch = [&writer, &batch, &n_batches]() {
+            batch.finish();
+            writer.write_batch(batch);
+            batch.clear();
+            ++n_batches;
+        };
+
+        const auto n_records = records::for_each_record(input, [&](simdjson::dom::element record) {
+            batch.append(record);
+            if (batch.length == batch_size) {
+                write_batch();
+            }
+        });
+        if (batch.length > 0) {
+            write_batch();
+        }
+        writer.close();
+
+        return std::make_pair(n_records, n_batches);
+    });
+}
+
+
+} // namespace ipc
+} // namespace arrow
+} // namespace rcppsimdjson
+
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef RCPPSIMDJSON_CACHE_HPP
+#define RCPPSIMDJSON_CACHE_HPP
+
+
+#include "common.hpp"
+
+#include <list>          /* std::list */
+#include <memory>        /* std::unique_ptr */
+#include <unordered_map> /* std::unordered_map */
+
+#include <sys/stat.h> /* stat() */
+
+
+namespace rcppsimdjson {
+namespace cache {
+
+
+enum class Policy : int {
+    lru  = 0, /* evict the least recently used documents to make room for new ones */
+    keep = 1, /* keep the documents already cached, and don't cache new ones once full */
+};
+
+
+/**
+ * @brief Parsed documents of the files `fload()` has seen, reused until their file changes.
+ *
+ * Entries are keyed by path and validated against the file's size and modification time on every
+ * lookup, so an edited file is parsed again. Since documents (rather than R objects) are kept,
+ * any query or option can be applied to a cached file. Their size is accounted as the memory
+ * simdjson allocated for them, which is roughly ten times that of the file.
+ */
+class Document_Cache {
+    struct Entry {
+        std::string                              path;
+        double                                   size;
+        double                                   mtime;
+        std::unique_ptr<simdjson::dom::document> document;
+        std::size_t                              bytes;
+    };
+
+    std::list<Entry>                                             entries; /* most recent first */
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::unique_ptr<simdjson::dom::document>                     uncached;
+
+    std::size_t max_bytes = 0U;
+    std::size_t n_bytes   = 0U;
+    Policy      policy    = Policy::lru;
+    double      hits      = 0.0;
+    double      misses    = 0.0;
+    double      evictions = 0.0;
+
+    inline void erase(std::list<Entry>::iterator entry);
+    inline auto make_room(std::size_t bytes) -> bool;
+
+  public:
+    inline auto is_enabled() const noexcept -> bool { return max_bytes > 0U; }
+
+    inline void configure(std::size_t new_max_bytes, Policy new_policy);
+
+    inline void clear();
+
+    inline auto info() const -> Rcpp::List;
+
+    /**
+     * @brief Find the document of the file at `path`, or parse it with `parse_into`.
+     *
+     * @param parse_into  A callable parsing the file into the `simdjson::dom::document&` it's
+     * given, returning its root as a `simdjson::simdjson_result<simdjson::dom::element>`.
+     *
+     * @return The document's root, valid until the next call (as with `parser.parse()`).
+     */
+    template <typename parse_fun_T>
+    inline auto load(const std::string& path, parse_fun_T&& parse_into)
+        -> simdjson::simdjson_result<simdjson::dom::element>;
+};
+
+
+/**
+ * @brief The memory `simdjson::dom::document::allocate()` took for `document`'s tape and strings.
+ */
+inline auto document_bytes(const simdjson::dom::document& document) -> std::size_t {
+    const auto capacity = document.capacity();
+    if (capacity == 0U) {
+        return 0U;
+    }
+    const auto tape_words   = SIMDJSON_ROUNDUP_N(capacity + 3, 64);
+    const auto string_bytes = SIMDJSON_ROUNDUP_N(5 * capacity / 3 + simdjson::SIMDJSON_PADDING, 64);
+    return sizeof(uint64_t) * tape_words + string_bytes;
+}
+
+
+inline auto modification_time(const struct stat& info) -> double {
+#if defined(__APPLE__)
+    return info.st_mtimespec.tv_sec + info.st_mtimespec.tv_nsec / 1e9;
+#elif defined(_WIN32)
+    return static_cast<double>(info.st_mtime);
+#else
+    return info.st_mtim.tv_sec + info.st_mtim.tv_nsec / 1e9;
+#endif
+}
+
+
+inline void Document_Cache::erase(const std::list<Entry>::iterator entry) {
+    n_bytes -= entry->bytes;
+    index.erase(entry->path);
+    entries.erase(entry);
+}
+
+
+/**
+ * @brief Whether `bytes` more fit in the cache, after evicting what the policy allows.
+ */
+inline auto Document_Cache::make_room(const std::size_t bytes) -> bool {
+    if (bytes > max_bytes) {
+        return false;
+    }
+    if (policy == Policy::keep) {
+        return n_bytes + bytes <= max_bytes;
+    }
+
+    while (n_bytes + bytes > max_bytes) {
+        erase(std::prev(std::end(entries)));
+        ++evictions;
+    }
+    return true;
+}
+
+
+inline void Document_Cache::configure(const std::size_t new_max_bytes, const Policy new_policy) {
+    max_bytes = new_max_bytes;
+    policy    = new_policy;
+
+    while (n_bytes > max_bytes) {
+        erase(std::prev(std::end(entries)));
+        ++evictions;
+    }
+    if (!is_enabled()) {
+        uncached.reset();
+    }
+}
+
+
+inline void Document_Cache::clear() {
+    entries.clear();
+    index.clear();
+    uncached.reset();
+    n_bytes   = 0U;
+    hits      = 0.0;
+    misses    = 0.0;
+    evictions = 0.0;
+}
+
+
+inline auto Document_Cache::info() const -> Rcpp::List {
+    return Rcpp::List::create(
+        Rcpp::_["max_size"]  = static_cast<double>(max_bytes),
+        Rcpp::_["policy"]    = policy == Policy::lru ? "lru" : "keep",
+        Rcpp::_["size"]      = static_cast<double>(n_bytes),
+        Rcpp::_["files"]     = static_cast<double>(std::size(entries)),
+        Rcpp::_["hits"]      = hits,
+        Rcpp::_["misses"]    = misses,
+        Rcpp::_["evictions"] = evictions);
+}
+
+
+template <typename parse_fun_T>
+inline auto Document_Cache::load(const std::string& path, parse_fun_T&& parse_into)
+    -> simdjson::simdjson_result<simdjson::dom::element> {
+
+    struct stat file_info;
+    if (stat(path.c_str(), &file_info) != 0) {
+        return simdjson::IO_ERROR;
+    }
+    const auto size  = static_cast<double>(file_info.st_size);
+    const auto mtime = modification_time(file_info);
+
+    if (const auto found = index.find(path); found != std::end(index)) {
+        if (const auto entry = found->second; entry->size == size && entry->mtime == mtime) {
+            ++hits;
+            entries.splice(std::begin(entries), entries, entry);
+            return entry->document->root();
+        } else { /* the file changed since it was cached */
+            erase(entry);
+        }
+    }
+    ++misses;
+
+    auto                   document = std::make_unique<simdjson::dom::document>();
+    simdjson::dom::element root;
+    if (const auto error = parse_into(*document).get(root); error != simdjson::SUCCESS) {
+        return error;
+    }
+
+    if (const auto bytes = document_bytes(*document); make_room(bytes)) {
+        entries.push_front(Entry{path, size, mtime, std::move(document), bytes});
+        index[path] = std::begin(entries);
+        n_bytes += bytes;
+    } else { /* kept only until the next load, like a parser's own document */
+        uncached = std::move(document);
+    }
+
+    return root;
+}
+
+
+/**
+ * @brief The package's only Document_Cache, disabled until `fload_cache()` gives it a size.
+ */
+inline auto file_cache() -> Document_Cache& {
+    static auto cache = Document_Cache();
+    return cache;
+}
+
+
+} // namespace cache
+} // namespace rcppsimdjson
+
+
+#endif
@@ -0,0 +1,572 @@
+#ifndef RCPPSIMDJSON_COLUMNS_HPP
+#define RCPPSIMDJSON_COLUMNS_HPP
+
+
+#include "deserialize.hpp"
+#include "serialize.hpp"
+
+
+namespace rcppsimdjson {
+namespace deserialize {
+
+
+/**
+ * @brief One column of a data frame built across documents, filled in as each one is parsed.
+ *
+ * A column whose type is declared is written straight into its R vector. Otherwise, each value is
+ * diagnosed by Type_Doctor as it is found and kept as a `Cell`: scalars as themselves, strings as
+ * CHARSXPs, and arrays and objects already deserialized. Once every document has been seen, the
+ * cells fill a vector of the column's common type, so documents never have to outlive their own
+ * parse, nor be parsed twice.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+class Document_Column {
+    /*
+     * A value of an undeclared column: if `found`, its JSON type and either its value or the index
+     * of its string in `strings` (or of its deserialized container in `containers`).
+     */
+    struct Cell {
+        bool                        found = false;
+        simdjson::dom::element_type type  = simdjson::dom::element_type::NULL_VALUE;
+        union {
+            int64_t  i64;
+            uint64_t u64;
+            double   dbl;
+            bool     lgl;
+            R_xlen_t index;
+        };
+    };
+
+    std::string_view                    pointer;
+    std::string_view                    key          = std::string_view();
+    bool                                is_key       = false;
+    std::optional<rcpp_T>               declared     = std::nullopt;
+    Rcpp::RObject                       values       = Rcpp::RObject();
+    R_xlen_t                            n_rows       = 0L;
+    Type_Doctor<type_policy, int64_opt> type_doc     = Type_Doctor<type_policy, int64_opt>();
+    std::vector<Cell>                   cells        = std::vector<Cell>();
+    Rcpp::CharacterVector               strings      = Rcpp::CharacterVector(0);
+    R_xlen_t                            n_strings    = 0L;
+    Rcpp::List                          containers   = Rcpp::List(0);
+    R_xlen_t                            n_containers = 0L;
+
+    inline void reserve(R_xlen_t capacity);
+
+    template <rcpp_T R_Type>
+    inline auto get_cell(const Cell& cell) const;
+
+    template <int RTYPE, rcpp_T R_Type>
+    inline auto fill_cells(typename Rcpp::traits::storage_type<RTYPE>::type na) const
+        -> Rcpp::Vector<RTYPE>;
+
+  public:
+    /**
+     * @param declared_type  An rcpp_T code, or NA_INTEGER to diagnose the column's type.
+     *
+     * @param capacity  The number of rows expected, which columns preallocate.
+     */
+    Document_Column(std::string_view pointer, int declared_type, R_xlen_t capacity);
+
+    /**
+     * @brief Append the value `pointer` finds relative to `row`, or NA if `row` is std::nullopt.
+     */
+    inline void add(std::optional<simdjson::dom::element> row, const Parse_Opts& nested_opts);
+
+    /**
+     * @brief Append `value` itself, or NA if it's std::nullopt.
+     */
+    inline void add_value(std::optional<simdjson::dom::element> value,
+                          const Parse_Opts&                     nested_opts);
+
+    inline auto finish(const Parse_Opts& nested_opts) -> SEXP;
+};
+
+
+/**
+ * @brief Make room for one more element after the first `size` elements of `vector`, doubling its
+ * length if it's full.
+ *
+ * The new element is created and stored by the caller afterwards, so that it's never left
+ * unprotected while `vector` is reallocated.
+ *
+ * @return The index of the new element.
+ */
+template <int RTYPE>
+inline auto grow(Rcpp::Vector<RTYPE>& vector, R_xlen_t& size) -> R_xlen_t {
+    if (size == Rf_xlength(vector)) {
+        vector = Rf_xlengthgets(vector, std::max(2 * size, R_xlen_t(1)));
+    }
+    return size++;
+}
+
+
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline Document_Column<type_policy, int64_opt>::Document_Column(const std::string_view pointer,
+                                                                const int      declared_type,
+                                                                const R_xlen_t capacity)
+    : pointer(pointer) {
+
+    if (key = pointer.substr(1); key.find_first_of("/~") == std::string_view::npos) {
+        is_key = true;
+    }
+
+    if (declared_type == NA_INTEGER) {
+        cells.reserve(capacity);
+        return;
+    }
+    declared = static_cast<rcpp_T>(declared_type);
+
+    switch (*declared) {
+        case rcpp_T::chr:
+            values = Rcpp::CharacterVector(0);
+            break;
+
+        case rcpp_T::dbl:
+        case rcpp_T::i64:
+            values = Rcpp::NumericVector(0);
+            break;
+
+        case rcpp_T::i32:
+            values = Rcpp::IntegerVector(0);
+            break;
+
+        case rcpp_T::lgl:
+            values = Rcpp::LogicalVector(0);
+            break;
+
+        default:
+            values = Rcpp::List(0);
+    }
+    reserve(capacity);
+}
+
+
+/**
+ * @brief Grow a declared column to `capacity` rows, filling them with its type's NA.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline void Document_Column<type_policy, int64_opt>::reserve(const R_xlen_t capacity) {
+    const auto n_old = Rf_xlength(values);
+    values           = Rf_xlengthgets(values, capacity); /* pads with NAs, or NULLs in lists */
+
+    if (*declared == rcpp_T::i64) {
+        std::fill(REAL(values) + n_old, REAL(values) + capacity, utils::int64_bits(NA_INTEGER64));
+    } else if (TYPEOF(values) == VECSXP) {
+        const auto na = Rcpp::LogicalVector(1, NA_LOGICAL);
+        for (auto i = n_old; i < capacity; ++i) {
+            SET_VECTOR_ELT(values, i, na);
+        }
+    }
+}
+
+
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline void
+Document_Column<type_policy, int64_opt>::add(std::optional<simdjson::dom::element> row,
+                                             const Parse_Opts&                     nested_opts) {
+    // rows aren't necessarily objects, so only those look a top-level key up directly
+    const auto find = [this](simdjson::dom::element parsed) {
+        return is_key && parsed.type() == simdjson::dom::element_type::OBJECT
+                   ? lookup(parsed, key)
+                   : lookup(parsed, Column_Pointer{pointer});
+    };
+
+    if (simdjson::dom::element value; row && find(*row).get(value) == simdjson::SUCCESS) {
+        add_value(value, nested_opts);
+    } else {
+        add_value(std::nullopt, nested_opts);
+    }
+}
+
+
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline void
+Document_Column<type_policy, int64_opt>::add_value(std::optional<simdjson::dom::element> value,
+                                                   const Parse_Opts& nested_opts) {
+    const auto i_row = n_rows++;
+
+    if (!declared) {
+        auto& cell = cells.emplace_back();
+        if (!value) {
+            return;
+        }
+        type_doc.add_element(*value);
+        cell.found = true;
+        cell.type  = value->type();
+
+        switch (cell.type) {
+            case simdjson::dom::element_type::ARRAY:
+            case simdjson::dom::element_type::OBJECT:
+                cell.index             = grow(containers, n_containers);
+                containers[cell.index] = deserialize(*value, nested_opts);
+                break;
+
+            case simdjson::dom::element_type::STRING: {
+                const auto string = std::string_view(*value);
+                cell.index        = grow(strings, n_strings);
+                SET_STRING_ELT(
+                    strings,
+                    cell.index,
+                    Rf_mkCharLenCE(string.data(), static_cast<int>(std::size(string)), CE_UTF8));
+                break;
+            }
+
+            case simdjson::dom::element_type::DOUBLE:
+                cell.dbl = double(*value);
+                break;
+
+            case simdjson::dom::element_type::INT64:
+                cell.i64 = int64_t(*value);
+                break;
+
+            case simdjson::dom::element_type::UINT64:
+                cell.u64 = uint64_t(*value);
+                break;
+
+            case simdjson::dom::element_type::BOOL:
+                cell.lgl = bool(*value);
+                break;
+
+            case simdjson::dom::element_type::NULL_VALUE:
+                break;
+        }
+        return;
+    }
+
+    if (i_row == Rf_xlength(values)) {
+        reserve(std::max(2 * i_row, R_xlen_t(1)));
+    }
+    if (!value) { /* already NA */
+        return;
+    }
+
+    switch (*declared) {
+        case rcpp_T::chr:
+            SET_STRING_ELT(values, i_row, get_declared_scalar<rcpp_T::chr>(*value).get_sexp());
+            break;
+
+        case rcpp_T::dbl:
+            REAL(values)[i_row] = get_declared_scalar<rcpp_T::dbl>(*value);
+            break;
+
+        case rcpp_T::i64:
+            REAL(values)[i_row] = utils::int64_bits(get_declared_scalar<rcpp_T::i64>(*value));
+            break;
+
+        case rcpp_T::i32:
+            INTEGER(values)[i_row] = get_declared_scalar<rcpp_T::i32>(*value);
+            break;
+
+        case rcpp_T::lgl:
+            LOGICAL(values)[i_row] = get_declared_scalar<rcpp_T::lgl>(*value);
+            break;
+
+        default:
+            SET_VECTOR_ELT(values, i_row, deserialize(*value, nested_opts));
+    }
+}
+
+
+/**
+ * @brief Convert a `cell` to an element of an `R_Type` vector, as get_scalar_dispatch() does for
+ * the element it was found as.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+template <rcpp_T R_Type>
+inline auto Document_Column<type_policy, int64_opt>::get_cell(const Cell& cell) const {
+    using simdjson::dom::element_type;
+
+    if constexpr (R_Type == rcpp_T::chr) {
+        switch (cell.type) {
+            case element_type::STRING:
+                return Rcpp::String(STRING_ELT(strings, cell.index));
+            case element_type::DOUBLE:
+                return utils::number_to_string(cell.dbl);
+            case element_type::INT64:
+                return utils::number_to_string(cell.i64);
+            case element_type::UINT64:
+                return utils::number_to_string(cell.u64);
+            case element_type::BOOL:
+                return cell.lgl ? Rcpp::String("TRUE") : Rcpp::String("FALSE");
+            default:
+                return Rcpp::String(NA_STRING);
+        }
+    }
+
+    if constexpr (R_Type == rcpp_T::dbl) {
+        switch (cell.type) {
+            case element_type::DOUBLE:
+                return cell.dbl;
+            case element_type::INT64:
+                return static_cast<double>(cell.i64);
+            case element_type::BOOL:
+                return cell.lgl ? 1.0 : 0.0;
+            default:
+                return NA_REAL;
+        }
+    }
+
+    if constexpr (R_Type == rcpp_T::i64) {
+        switch (cell.type) {
+            case element_type::INT64:
+                return utils::int64_bits(cell.i64);
+            case element_type::BOOL:
+                return utils::int64_bits(cell.lgl ? int64_t(1) : int64_t(0));
+            default:
+                return utils::int64_bits(NA_INTEGER64);
+        }
+    }
+
+    if constexpr (R_Type == rcpp_T::i32) {
+        switch (cell.type) {
+            case element_type::INT64:
+                return static_cast<int>(cell.i64);
+            case element_type::BOOL:
+                return cell.lgl ? 1 : 0;
+            default:
+                return NA_INTEGER;
+        }
+    }
+
+    if constexpr (R_Type == rcpp_T::lgl) {
+        return cell.type == element_type::BOOL ? static_cast<int>(cell.lgl) : NA_LOGICAL;
+    }
+}
+
+
+/**
+ * @brief Fill an `RTYPE` vector from every cell, leaving rows without a value as `na`.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+template <int RTYPE, rcpp_T R_Type>
+inline auto Document_Column<type_policy, int64_opt>::fill_cells(
+    const typename Rcpp::traits::storage_type<RTYPE>::type na) const -> Rcpp::Vector<RTYPE> {
+
+    auto out = Rcpp::Vector<RTYPE>(n_rows, na);
+    for (R_xlen_t i_row = 0; i_row < n_rows; ++i_row) {
+        if (cells[i_row].found) {
+            out[i_row] = get_cell<R_Type>(cells[i_row]);
+        }
+    }
+    return out;
+}
+
+
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline auto Document_Column<type_policy, int64_opt>::finish(const Parse_Opts& nested_opts) -> SEXP {
+    if (declared) {
+        if (Rf_xlength(values) != n_rows) {
+            values = Rf_xlengthgets(values, n_rows);
+        }
+        return *declared == rcpp_T::i64 ? utils::as_integer64(Rcpp::NumericVector(values))
+                                        : compact::compact(values);
+    }
+
+    switch (type_doc.common_R_type()) {
+        case rcpp_T::chr:
+        case rcpp_T::u64:
+            return compact::compact(fill_cells<STRSXP, rcpp_T::chr>(NA_STRING));
+
+        case rcpp_T::dbl:
+            return compact::compact(fill_cells<REALSXP, rcpp_T::dbl>(NA_REAL));
+
+        case rcpp_T::i64:
+            if constexpr (int64_opt == utils::Int64_R_Type::Double) {
+                return compact::compact(fill_cells<REALSXP, rcpp_T::dbl>(NA_REAL));
+            } else if constexpr (int64_opt == utils::Int64_R_Type::String) {
+                return compact::compact(fill_cells<STRSXP, rcpp_T::chr>(NA_STRING));
+            } else {
+                return compact::compact(utils::as_integer64(
+                    fill_cells<REALSXP, rcpp_T::i64>(utils::int64_bits(NA_INTEGER64))));
+            }
+
+        case rcpp_T::i32:
+            return compact::compact(fill_cells<INTSXP, rcpp_T::i32>(NA_INTEGER));
+
+        case rcpp_T::lgl:
+        case rcpp_T::null:
+            return compact::compact(fill_cells<LGLSXP, rcpp_T::lgl>(NA_LOGICAL));
+
+        default: {
+            /* containers, or types that don't mix: each value is an element of a list */
+            auto out = Rcpp::List(n_rows);
+            for (R_xlen_t i_row = 0; i_row < n_rows; ++i_row) {
+                const auto& cell = cells[i_row];
+                if (!cell.found) {
+                    out[i_row] = NA_LOGICAL;
+                    continue;
+                }
+                switch (cell.type) {
+                    case simdjson::dom::element_type::ARRAY:
+                    case simdjson::dom::element_type::OBJECT:
+                        out[i_row] = containers[cell.index];
+                        break;
+                    case simdjson::dom::element_type::STRING:
+                        out[i_row] = Rf_ScalarString(STRING_ELT(strings, cell.index));
+                        break;
+                    case simdjson::dom::element_type::DOUBLE:
+                        out[i_row] = cell.dbl;
+                        break;
+                    case simdjson::dom::element_type::INT64:
+                        out[i_row] = utils::resolve_int64<int64_opt>(cell.i64);
+                        break;
+                    case simdjson::dom::element_type::UINT64:
+                        out[i_row] = utils::number_to_string(cell.u64);
+                        break;
+                    case simdjson::dom::element_type::BOOL:
+                        out[i_row] = Rcpp::wrap(cell.lgl);
+                        break;
+                    case simdjson::dom::element_type::NULL_VALUE:
+                        out[i_row] = nested_opts.single_null;
+                        break;
+                }
+            }
+            return out;
+        }
+    }
+}
+
+
+/**
+ * @brief Build a single data frame from every document in `json`, parsing each one only once.
+ *
+ * Without `base`, each document is a row, and `NA` documents, and those that fail to parse if
+ * `parse_error_ok`, are rows of NAs. With `base`, the rows are every value it finds in each
+ * document (or, if that's an array, its elements), and the data frame starts with a `.document`
+ * column of the (1-based) index of the document each row came from. Documents that have no such
+ * value, are `NA`, or fail to parse if `parse_error_ok` have no rows.
+ *
+ * Unless `on_parse_error` is R_NilValue, a document that fails to parse is instead a single row
+ * whose every column is `on_parse_error`, written as JSON (with length-1 vectors as scalars) and
+ * then diagnosed like any other value.
+ *
+ * @param columns  Named character vector of JSON Pointers, relative to each row. Pointers to a
+ * top-level key are looked up with `at_key()`.
+ *
+ * @param base  A JSON Pointer, which may include wildcards and slices, or R_NilValue.
+ *
+ * @param types  Integer vector of rcpp_T codes (NA_INTEGER to diagnose the column) parallel to
+ * `columns`, or R_NilValue to diagnose every column.
+ *
+ * @param on_parse_error  The value of a document that fails to parse, or R_NilValue.
+ */
+template <typename json_T, bool is_file>
+inline auto build_document_columns(const json_T&                json,
+                                   const Rcpp::CharacterVector& columns,
+                                   SEXP                         base,
+                                   SEXP                         types,
+                                   const bool                   parse_error_ok,
+                                   SEXP                         on_parse_error,
+                                   const Parse_Opts&            parse_opts) -> SEXP {
+
+    const auto n_docs = R_xlen_t(std::size(json));
+    const auto n_cols = r_length(columns);
+
+    auto base_tokens = std::optional<std::vector<pointer::Token>>();
+    if (!Rf_isNull(base)) {
+        base_tokens = pointer::tokenize(CHAR(STRING_ELT(base, 0)));
+        if (!base_tokens) {
+            Rcpp::stop("`base=` must be a JSON Pointer, starting with \"/\" (or \"$/\").");
+        }
+    }
+
+    simdjson::dom::parser  error_parser;
+    simdjson::dom::element error_value;
+    if (!Rf_isNull(on_parse_error)) {
+        auto serializer = serialize::Serializer(serialize::Serialize_Opts{true, true});
+        serializer.write_value(on_parse_error);
+        if (error_parser.parse(serializer.out).get(error_value) != simdjson::SUCCESS) {
+            Rcpp::stop("Failed to write `on_parse_error=` as JSON."); // # nocov
+        }
+    }
+
+    const auto build = [&](auto policy, auto int64_r_type) -> SEXP {
+        using column_T = Document_Column<decltype(policy)::value, decltype(int64_r_type)::value>;
+
+        auto cols = std::vector<column_T>();
+        cols.reserve(n_cols);
+        for (R_xlen_t j = 0; j < n_cols; ++j) {
+            cols.emplace_back(std::string_view(CHAR(STRING_ELT(columns, j))),
+                              Rf_isNull(types) ? NA_INTEGER : INTEGER(types)[j],
+                              n_docs);
+        }
+
+        auto doc_index = std::vector<int>();
+        auto i_doc     = R_xlen_t(0L);
+        auto add_row   = [&cols, &doc_index, &i_doc, &parse_opts](simdjson::dom::element row) {
+            doc_index.push_back(static_cast<int>(i_doc + 1));
+            for (auto& col : cols) {
+                col.add(row, parse_opts);
+            }
+        };
+        auto add_rows = [&add_row](simdjson::dom::element found) {
+            if (simdjson::dom::array array; found.get(array) == simdjson::SUCCESS) {
+                for (auto row : array) {
+                    add_row(row);
+                }
+            } else {
+                add_row(found);
+            }
+        };
+
+        simdjson::dom::parser parser;
+        for (i_doc = 0; i_doc < n_docs; ++i_doc) {
+            auto document = std::optional<simdjson::dom::element>();
+            if (!utils::is_na_string(json[i_doc])) {
+                simdjson::dom::element parsed;
+                const auto             error =
+                    parse<decltype(json[i_doc]), is_file>(parser, json[i_doc]).get(parsed);
+                if (error == simdjson::SUCCESS) {
+                    document = parsed;
+                } else if (!parse_error_ok) {
+                    Rcpp::stop(simdjson::error_message(error));
+                } else if (!Rf_isNull(on_parse_error)) {
+                    if (base_tokens) {
+                        doc_index.push_back(static_cast<int>(i_doc + 1));
+                    }
+                    for (auto& col : cols) {
+                        col.add_value(error_value, parse_opts);
+                    }
+                    continue;
+                }
+            }
+
+            if (!base_tokens) {
+                for (auto& col : cols) {
+                    col.add(document, parse_opts);
+                }
+            } else if (document) {
+                pointer::for_each_match(*document, *base_tokens, 0, add_rows);
+            }
+        }
+
+        const auto has_index = R_xlen_t(base_tokens.has_value());
+        const auto n_rows    = has_index ? R_xlen_t(std::size(doc_index)) : n_docs;
+        auto       out       = Rcpp::List(n_cols + has_index);
+        auto       out_names = Rcpp::CharacterVector(n_cols + has_index);
+        if (has_index) {
+            out[0]       = Rcpp::IntegerVector(std::begin(doc_index), std::end(doc_index));
+            out_names[0] = ".document";
+        }
+        const auto col_names = Rcpp::CharacterVector(columns.attr("names"));
+        for (R_xlen_t j = 0; j < n_cols; ++j) {
+            out[j + has_index]       = cols[j].finish(parse_opts);
+            out_names[j + has_index] = col_names[j];
+        }
+
+        out.attr("names")     = out_names;
+        out.attr("row.names") = Rcpp::seq_len(n_rows); /* `Rcpp::seq()` throws if `n_rows == 0` */
+        out.attr("class")     = "data.frame";
+
+        return out;
+    };
+
+    return dispatch_parse_opts(parse_opts, build);
+}
+
+
+} // namespace deserialize
+} // namespace rcppsimdjson
+
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef RCPPSIMDJSON_COMPACT_HPP
+#define RCPPSIMDJSON_COMPACT_HPP
+
+
+#include <Rcpp.h>
+
+#include <algorithm> /* std::min */
+#include <cmath>     /* std::isfinite */
+#include <cstdint>   /* int64_t */
+#include <cstring>   /* std::memcmp */
+#include <optional>  /* std::optional */
+
+#include <Rversion.h>
+
+/* ALTREP vectors were added in R 3.5.0; before that, columns are simply kept as they are */
+#if R_VERSION >= R_Version(3, 5, 0)
+#    include <R_ext/Altrep.h>
+#    define RCPPSIMDJSON_HAS_ALTREP
+#endif
+
+
+namespace rcppsimdjson {
+namespace compact {
+
+
+/**
+ * @brief Vectors shorter than this are never compacted: they're cheap as they are, and every
+ * access to an ALTREP vector costs a method call.
+ */
+inline constexpr R_xlen_t MIN_LENGTH = 128;
+
+
+#ifdef RCPPSIMDJSON_HAS_ALTREP
+
+/**
+ * @brief The package's ALTREP class for compact vectors of `RTYPE`, registered by
+ * `R_init_RcppSimdJson()`.
+ */
+template <int RTYPE>
+inline auto compact_class() -> R_altrep_class_t& {
+    static auto altrep_class = R_altrep_class_t{nullptr};
+    return altrep_class;
+}
+
+
+/**
+ * @brief A vector whose elements are `first + i * step`: an arithmetic sequence of numbers, or
+ * (with a `step` of zero, and for logical and character vectors) a single repeated value.
+ *
+ * `data1` is a list of the `first` and `step` (a vector of `RTYPE`) and the length; `data2` is
+ * `R_NilValue` until the vector is expanded, which is only ever done if its data is asked for.
+ */
+template <int RTYPE>
+struct Compact_Vector {
+    static SEXP values(SEXP x) { return VECTOR_ELT(R_altrep_data1(x), 0); }
+
+    static R_xlen_t Length(SEXP x) {
+        return static_cast<R_xlen_t>(REAL_ELT(VECTOR_ELT(R_altrep_data1(x), 1), 0));
+    }
+
+    static auto is_expanded(SEXP x) -> bool { return R_altrep_data2(x) != R_NilValue; }
+
+    static auto step(SEXP x) {
+        if constexpr (RTYPE == REALSXP) {
+            return REAL_ELT(values(x), 1);
+        } else if constexpr (RTYPE == INTSXP) {
+            return INTEGER_ELT(values(x), 1);
+        } else {
+            return 0;
+        }
+    }
+
+    static auto value(SEXP x, R_xlen_t i) {
+        if constexpr (RTYPE == REALSXP) {
+            /* a zero `step` keeps NAs and negative zeros exactly as they were */
+            const auto by = step(x);
+            return by == 0 ? REAL_ELT(values(x), 0)
+                           : REAL_ELT(values(x), 0) + static_cast<double>(i) * by;
+        } else if constexpr (RTYPE == INTSXP) {
+            return static_cast<int>(INTEGER_ELT(values(x), 0) + static_cast<int64_t>(i) * step(x));
+        } else if constexpr (RTYPE == LGLSXP) {
+            return LOGICAL_ELT(values(x), 0);
+        } else {
+            return STRING_ELT(values(x), 0);
+        }
+    }
+
+    static SEXP expanded(SEXP x) {
+        if (!is_expanded(x)) {
+            const auto n   = Length(x);
+            auto       out = Rcpp::Vector<RTYPE>(n);
+            for (R_xlen_t i = 0; i < n; ++i) {
+                out[i] = value(x, i);
+            }
+            R_set_altrep_data2(x, out);
+        }
+        return R_altrep_data2(x);
+    }
+
+    /* once expanded, the data may have been written to, so it's all that can be trusted */
+    static auto Elt(SEXP x, R_xlen_t i) {
+        if (!is_expanded(x)) {
+            return value(x, i);
+        }
+        if constexpr (RTYPE == REALSXP) {
+            return REAL_ELT(R_altrep_data2(x), i);
+        } else if constexpr (RTYPE == INTSXP) {
+            return INTEGER_ELT(R_altrep_data2(x), i);
+        } else if constexpr (RTYPE == LGLSXP) {
+            return LOGICAL_ELT(R_altrep_data2(x), i);
+        } else {
+            return STRING_ELT(R_altrep_data2(x), i);
+        }
+    }
+
+    static void Set_elt(SEXP x, R_xlen_t i, SEXP value) {
+        SET_STRING_ELT(expanded(x), i, value);
+    }
+
+    template <typename value_T>
+    static R_xlen_t Get_region(SEXP x, R_xlen_t i, R_xlen_t n, value_T* out) {
+        const auto n_copied = std::min(n, Length(x) - i);
+        for (R_xlen_t j = 0; j < n_copied; ++j) {
+            out[j] = Elt(x, i + j);
+        }
+        return n_copied;
+    }
+
+    static void* Dataptr(SEXP x, Rboolean /* writeable */) { return DATAPTR(expanded(x)); }
+
+    static const void* Dataptr_or_null(SEXP x) {
+        return is_expanded(x) ? DATAPTR(R_altrep_data2(x)) : nullptr;
+    }
+
+    static auto is_na(SEXP x) -> bool {
+        if constexpr (RTYPE == REALSXP) {
+            return std::isnan(REAL_ELT(values(x), 0));
+        } else if constexpr (RTYPE == INTSXP) {
+            return INTEGER_ELT(values(x), 0) == NA_INTEGER;
+        } else if constexpr (RTYPE == LGLSXP) {
+            return LOGICAL_ELT(values(x), 0) == NA_LOGICAL;
+        } else {
+            return STRING_ELT(values(x), 0) == NA_STRING;
+        }
+    }
+
+    static int Is_sorted(SEXP x) {
+        if (is_expanded(x) || is_na(x)) {
+            return UNKNOWN_SORTEDNESS;
+        }
+        return step(x) < 0 ? SORTED_DECR : SORTED_INCR;
+    }
+
+    static int No_NA(SEXP x) { return !is_expanded(x) && !is_na(x); }
+
+    /* copies share the compact values, so modifying one doesn't expand the other */
+    static SEXP Duplicate(SEXP x, Rboolean /* deep */) {
+        return is_expanded(x) ? nullptr
+                              : R_new_altrep(compact_class<RTYPE>(), R_altrep_data1(x), R_NilValue);
+    }
+
+    static Rboolean
+    Inspect(SEXP x, int /* pre */, int /* deep */, int /* pvec */, void (*)(SEXP, int, int, int)) {
+        Rprintf("compact JSON %s (%td elements%s)\n",
+                step(x) == 0 ? "constant" : "sequence",
+                Length(x),
+                is_expanded(x) ? ", expanded" : "");
+        return TRUE;
+    }
+};
+
+
+template <int RTYPE>
+inline void register_class(R_altrep_class_t altrep_class) {
+    using Methods = Compact_Vector<RTYPE>;
+
+    compact_class<RTYPE>() = altrep_class;
+    R_set_altrep_Length_method(altrep_class, Methods::Length);
+    R_set_altrep_Inspect_method(altrep_class, Methods::Inspect);
+    R_set_altrep_Duplicate_method(altrep_class, Methods::Duplicate);
+    R_set_altvec_Dataptr_method(altrep_class, Methods::Dataptr);
+    R_set_altvec_Dataptr_or_null_method(altrep_class, Methods::Dataptr_or_null);
+
+    if constexpr (RTYPE == REALSXP) {
+        R_set_altreal_Elt_method(altrep_class, Methods::Elt);
+        R_set_altreal_Get_region_method(altrep_class, Methods::template Get_region<double>);
+        R_set_altreal_Is_sorted_method(altrep_class, Methods::Is_sorted);
+        R_set_altreal_No_NA_method(altrep_class, Methods::No_NA);
+    } else if constexpr (RTYPE == INTSXP) {
+        R_set_altinteger_Elt_method(altrep_class, Methods::Elt);
+        R_set_altinteger_Get_region_method(altrep_class, Methods::template Get_region<int>);
+        R_set_altinteger_Is_sorted_method(altrep_class, Methods::Is_sorted);
+        R_set_altinteger_No_NA_method(altrep_class, Methods::No_NA);
+    } else if constexpr (RTYPE == LGLSXP) {
+        R_set_altlogical_Elt_method(altrep_class, Methods::Elt);
+        R_set_altlogical_Get_region_method(altrep_class, Methods::template Get_region<int>);
+        R_set_altlogical_No_NA_method(altrep_class, Methods::No_NA);
+    } else {
+        R_set_altstring_Elt_method(altrep_class, Methods::Elt);
+        R_set_altstring_Set_elt_method(altrep_class, Methods::Set_elt);
+        R_set_altstring_No_NA_method(altrep_class, Methods::No_NA);
+    }
+}
+
+
+inline void register_classes(DllInfo* dll) {
+    register_class<REALSXP>(R_make_altreal_class("compact_json_dbl", "RcppSimdJson", dll));
+    register_class<INTSXP>(R_make_altinteger_class("compact_json_int", "RcppSimdJson", dll));
+    register_class<LGLSXP>(R_make_altlogical_class("compact_json_lgl", "RcppSimdJson", dll));
+    register_class<STRSXP>(R_make_altstring_class("compact_json_chr", "RcppSimdJson", dll));
+}
+
+
+/**
+ * @brief The `first` and `step` of `x` if all of its elements are `first + i * step`.
+ *
+ * Doubles are compared bit for bit, so that what `Compact_Vector<REALSXP>::Elt()` computes is
+ * exactly what was parsed. Non-constant sequences can't contain NAs.
+ */
+template <int RTYPE>
+inline auto sequence_of(SEXP x) -> std::optional<Rcpp::Vector<RTYPE>> {
+    const auto n = XLENGTH(x);
+
+    if constexpr (RTYPE == REALSXP) {
+        const double* const v     = REAL(x);
+        const auto          first = v[0];
+        const auto          by    = std::memcmp(&v[1], &first, sizeof(double)) == 0 ? 0.0
+                                                                                     : v[1] - first;
+        if (by != 0 && !(std::isfinite(first) && std::isfinite(by))) {
+            return std::nullopt;
+        }
+        /* `v[1]` too: `first + by` may round differently, and `-0.0 - 0.0` is a zero `by` */
+        for (R_xlen_t i = 1; i < n; ++i) {
+            const auto expected = by == 0 ? first : first + static_cast<double>(i) * by;
+            if (std::memcmp(&v[i], &expected, sizeof(double)) != 0) {
+                return std::nullopt;
+            }
+        }
+        return Rcpp::NumericVector::create(first, by);
+
+    } else if constexpr (RTYPE == INTSXP) {
+        const int* const v     = INTEGER(x);
+        const auto       first = int64_t(v[0]);
+        const auto       by    = int64_t(v[1]) - first;
+        if (by != 0 && (v[0] == NA_INTEGER || v[1] == NA_INTEGER)) {
+            return std::nullopt;
+        }
+        for (R_xlen_t i = 2; i < n; ++i) {
+            if (v[i] != first + i * by || (by != 0 && v[i] == NA_INTEGER)) {
+                return std::nullopt;
+            }
+        }
+        return Rcpp::IntegerVector::create(v[0], static_cast<int>(by));
+
+    } else if constexpr (RTYPE == LGLSXP) {
+        const int* const v = LOGICAL(x);
+        for (R_xlen_t i = 1; i < n; ++i) {
+            if (v[i] != v[0]) {
+                return std::nullopt;
+            }
+        }
+        return Rcpp::LogicalVector::create(v[0]);
+
+    } else {
+        /* R caches strings, so equal strings are the same CHARSXP */
+        const SEXP first = STRING_ELT(x, 0);
+        for (R_xlen_t i = 1; i < n; ++i) {
+            if (STRING_ELT(x, i) != first) {
+                return std::nullopt;
+            }
+        }
+        return Rcpp::CharacterVector::create(first);
+    }
+}
+
+#endif
+
+
+/**
+ * @brief `x`, as a compact ALTREP vector if it's a long enough arithmetic sequence or repeats a
+ * single value.
+ *
+ * Only plain double, integer, logical, and character vectors are compacted; anything with a class
+ * (e.g. integer64) is returned as it is.
+ */
+inline auto compact(SEXP x) -> SEXP {
+#ifdef RCPPSIMDJSON_HAS_ALTREP
+    if (compact_class<REALSXP>().ptr == nullptr || ALTREP(x) || Rf_isObject(x) ||
+        XLENGTH(x) < MIN_LENGTH) {
+        return x;
+    }
+
+    const auto make = [x](auto sequence, R_altrep_class_t altrep_class) -> SEXP {
+        if (!sequence) {
+            return x;
+        }
+        const auto data1 = Rcpp::List::create(*sequence, static_cast<double>(XLENGTH(x)));
+        return R_new_altrep(altrep_class, data1, R_NilValue);
+    };
+
+    switch (TYPEOF(x)) {
+        case REALSXP:
+            return make(sequence_of<REALSXP>(x), compact_class<REALSXP>());
+        case INTSXP:
+            return make(sequence_of<INTSXP>(x), compact_class<INTSXP>());
+        case LGLSXP:
+            return make(sequence_of<LGLSXP>(x), compact_class<LGLSXP>());
+        case STRSXP:
+            return make(sequence_of<STRSXP>(x), compact_class<STRSXP>());
+        default:
+            return x;
+    }
+#else
+    return x;
+#endif
+}
+
+
+#ifndef RCPPSIMDJSON_HAS_ALTREP
+inline void register_classes(DllInfo* /* dll */) {}
+#endif
+
+
+} // namespace compact
+} // namespace rcppsimdjson
+
+
+#endif
@@ -0,0 +1,332 @@
+#ifndef RCPPSIMDJSON_CSV_HPP
+#define RCPPSIMDJSON_CSV_HPP
+
+
+#include "common.hpp"
+#include "pointer.hpp"
+#include "records.hpp"
+
+#include <array>       /* std::array */
+#include <cstdio>      /* std::FILE, std::fopen, std::fwrite, std::fclose */
+#include <map>         /* std::map */
+#include <memory>      /* std::unique_ptr */
+#include <optional>    /* std::optional */
+#include <string>      /* std::string */
+#include <string_view> /* std::string_view */
+#include <vector>      /* std::vector */
+
+
+namespace rcppsimdjson {
+namespace csv {
+
+
+/**
+ * @brief Writes delimited text, a field at a time, through a buffer that's flushed to the file
+ * whenever it fills up.
+ *
+ * Fields are quoted (and their quotes doubled) only if they contain the separator, a quote, or a
+ * line break. Empty strings are always quoted, so they can't be confused with an empty `na`.
+ */
+class Writer {
+    static constexpr std::size_t FLUSH_SIZE = 1 << 20;
+
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file;
+    std::string                                        path;
+    std::string                                        buffer   = std::string();
+    char                                               sep;
+    std::string                                        specials; /* what makes a field quoted */
+    std::string                                        na;
+    bool                                               is_first = true;
+
+    inline auto flush() -> void {
+        if (std::fwrite(buffer.data(), 1, std::size(buffer), file.get()) != std::size(buffer)) {
+            Rcpp::stop("Failed to write to '" + path + "'."); // # nocov
+        }
+        buffer.clear();
+    }
+
+    inline auto start_field() -> void {
+        if (!is_first) {
+            buffer.push_back(sep);
+        }
+        is_first = false;
+    }
+
+  public:
+    Writer(const std::string& path, const char sep, std::string na)
+        : file(std::fopen(path.c_str(), "wb"), &std::fclose),
+          path(path),
+          sep(sep),
+          specials(std::string("\"\n\r") + sep),
+          na(std::move(na)) {
+        if (!file) {
+            Rcpp::stop("Failed to open '" + path + "'.");
+        }
+        buffer.reserve(FLUSH_SIZE + utils::NUMBER_BUFFER_SIZE);
+    }
+
+    inline auto write_na() -> void {
+        start_field();
+        buffer.append(na);
+    }
+
+    inline auto write_string(const std::string_view x) -> void {
+        start_field();
+        if (!x.empty() && x.find_first_of(specials) == std::string_view::npos) {
+            buffer.append(x);
+            return;
+        }
+        buffer.push_back('"');
+        for (auto quote = x.find('"'), start = std::size_t(0);; quote = x.find('"', start)) {
+            buffer.append(x.substr(start, quote - start));
+            if (quote == std::string_view::npos) {
+                break;
+            }
+            buffer.append("\"\"");
+            start = quote + 1;
+        }
+        buffer.push_back('"');
+    }
+
+    template <typename number_T>
+    inline auto write_number(const number_T x) -> void {
+        start_field();
+        std::array<char, utils::NUMBER_BUFFER_SIZE> number;
+        const auto end = utils::format_number(number.data(), number.data() + number.size(), x);
+        buffer.append(number.data(), end - number.data());
+    }
+
+    /**
+     * @brief Write a scalar as text, a `null` as `na`, and an array or object as minified JSON.
+     */
+    inline auto write_element(simdjson::dom::element element) -> void {
+        switch (element.type()) {
+            case simdjson::dom::element_type::STRING:
+                write_string(std::string_view(element));
+                break;
+
+            case simdjson::dom::element_type::INT64:
+                write_number(int64_t(element));
+                break;
+
+            case simdjson::dom::element_type::UINT64:
+                write_number(uint64_t(element));
+                break;
+
+            case simdjson::dom::element_type::DOUBLE:
+                write_number(double(element));
+                break;
+
+            case simdjson::dom::element_type::BOOL:
+                start_field();
+                buffer.append(bool(element) ? "true" : "false");
+                break;
+
+            case simdjson::dom::element_type::NULL_VALUE:
+                write_na();
+                break;
+
+            default:
+                write_string(simdjson::minify(element));
+                break;
+        }
+    }
+
+    inline auto end_row() -> void {
+        buffer.push_back('\n');
+        is_first = true;
+        if (std::size(buffer) >= FLUSH_SIZE) {
+            flush();
+        }
+    }
+
+    inline auto close() -> void {
+        flush();
+        if (std::fclose(file.release()) != 0) {
+            Rcpp::stop("Failed to write to '" + path + "'."); // # nocov
+        }
+    }
+};
+
+
+/**
+ * @brief The columns of records flattened into dotted names, e.g. `{"user":{"id":1}}` into
+ * `user.id`, in the order they're first seen.
+ *
+ * Keys are kept in a trie, so a record is flattened without building any names. Anything but a
+ * non-empty object (arrays included) is a leaf, i.e. a column.
+ */
+class Flattener {
+    struct Node {
+        std::string                                      name;
+        std::map<std::string, std::size_t, std::less<>> children;
+        std::optional<std::size_t>                       column;
+    };
+
+    std::vector<Node> nodes = std::vector<Node>(1);
+
+    inline auto add(simdjson::dom::element element, std::size_t node) -> void;
+
+    inline auto fill(simdjson::dom::element                              element,
+                     std::size_t                                         node,
+                     std::vector<std::optional<simdjson::dom::element>>& row) const -> void;
+
+  public:
+    std::vector<std::string> names = std::vector<std::string>();
+
+    /**
+     * @brief Add any columns of `record` that haven't been seen yet.
+     */
+    inline auto add(simdjson::dom::element record) -> void { add(record, 0); }
+
+    /**
+     * @brief Set `row[column]` to `record`'s value of each column, or std::nullopt.
+     */
+    inline auto fill(simdjson::dom::element                              record,
+                     std::vector<std::optional<simdjson::dom::element>>& row) const -> void {
+        std::fill(std::begin(row), std::end(row), std::nullopt);
+        fill(record, 0, row);
+    }
+};
+
+
+inline auto Flattener::add(simdjson::dom::element element, const std::size_t node) -> void {
+    if (simdjson::dom::object object;
+        element.get(object) == simdjson::SUCCESS && std::size(object) > 0) {
+        for (auto [key, value] : object) {
+            auto child = nodes[node].children.find(key);
+            if (child == std::end(nodes[node].children)) {
+                child = nodes[node].children.emplace(key, std::size(nodes)).first;
+                nodes.push_back(
+                    {node == 0 ? std::string(key) : nodes[node].name + "." + std::string(key)});
+            }
+            add(value, child->second);
+        }
+        return;
+    }
+
+    if (node == 0) {
+        if (element.type() != simdjson::dom::element_type::OBJECT && !element.is_null()) {
+            Rcpp::stop("Every record must be a JSON object, unless 'columns=' are given.");
+        }
+        return; /* `{}` and `null` are rows of `na`s */
+    }
+    if (!nodes[node].column) {
+        nodes[node].column = std::size(names);
+        names.push_back(nodes[node].name);
+    }
+}
+
+
+inline auto Flattener::fill(simdjson::dom::element                              element,
+                            const std::size_t                                   node,
+                            std::vector<std::optional<simdjson::dom::element>>& row) const
+    -> void {
+    if (simdjson::dom::object object;
+        element.get(object) == simdjson::SUCCESS && std::size(object) > 0) {
+        for (auto [key, value] : object) {
+            if (const auto child = nodes[node].children.find(key);
+                child != std::end(nodes[node].children)) {
+                fill(value, child->second, row);
+            }
+        }
+        return;
+    }
+
+    // like `at_key()`, only the first of any duplicated keys is kept
+    if (const auto column = nodes[node].column; column && !row[*column]) {
+        row[*column] = element;
+    }
+}
+
+
+/**
+ * @brief Write the records of the JSON file at `input` (NDJSON or a top-level array) to `output`
+ * as delimited text, one row per record.
+ *
+ * With `columns` (JSON Pointers named by their column names), each row holds the value each
+ * pointer finds, resolved for all columns at once by a pointer::Query_Trie. Pointers with
+ * wildcards or slices hold a JSON array of their matches. Otherwise, records are streamed twice:
+ * first to flatten their keys into columns, then to write them.
+ *
+ * @return The number of records and of columns.
+ */
+inline auto json_to_csv(const std::string&                          input,
+                        const std::string&                          output,
+                        const std::optional<Rcpp::CharacterVector>& columns,
+                        const char                                  sep,
+                        const std::string&                          na,
+                        const bool                                  header)
+    -> std::pair<int64_t, std::size_t> {
+
+    auto flattener = Flattener();
+    auto names     = std::vector<std::string>();
+    if (columns) {
+        const auto column_names = Rcpp::CharacterVector(Rf_getAttrib(*columns, R_NamesSymbol));
+        for (R_xlen_t i = 0; i < r_length(column_names); ++i) {
+            names.emplace_back(CHAR(STRING_ELT(column_names, i)));
+        }
+    } else {
+        records::for_each_record(
+            input, [&flattener](simdjson::dom::element record) { flattener.add(record); });
+        names = flattener.names;
+    }
+
+    auto writer = Writer(output, sep, na);
+    if (header && !names.empty()) {
+        for (const auto& name : names) {
+            writer.write_string(name);
+        }
+        writer.end_row();
+    }
+
+    auto n_records = int64_t(0);
+    if (columns) {
+        auto trie    = pointer::Query_Trie(*columns);
+        auto matches = std::string();
+        n_records    = records::for_each_record(input, [&](simdjson::dom::element record) {
+            const auto& found = trie.resolve(record);
+            for (std::size_t i = 0; i < std::size(found); ++i) {
+                if (const auto& tokens = trie.fan_out(i)) {
+                    matches.assign("[");
+                    auto collect = [&matches](simdjson::dom::element match) {
+                        matches.append(simdjson::minify(match)).push_back(',');
+                    };
+                    pointer::for_each_match(record, *tokens, 0, collect);
+                    if (matches.back() == ',') {
+                        matches.pop_back();
+                    }
+                    writer.write_string(matches.append("]"));
+                } else if (found[i]) {
+                    writer.write_element(*found[i]);
+                } else {
+                    writer.write_na();
+                }
+            }
+            writer.end_row();
+        });
+    } else {
+        auto row  = std::vector<std::optional<simdjson::dom::element>>(std::size(names));
+        n_records = records::for_each_record(input, [&](simdjson::dom::element record) {
+            flattener.fill(record, row);
+            for (const auto& value : row) {
+                if (value) {
+                    writer.write_element(*value);
+                } else {
+                    writer.write_na();
+                }
+            }
+            writer.end_row();
+        });
+    }
+    writer.close();
+
+    return std::make_pair(n_records, std::size(names));
+}
+
+
+} // namespace csv
+} // namespace rcppsimdjson
+
+
+#endif
@@ -2,7 +2,14 @@
 #define RCPPSIMDJSON__DESERIALIZE_HPP
 
 
+#include <memory>        /* std::shared_ptr */
+#include <string_view>   /* std::string_view */
+#include <unordered_map> /* std::unordered_map */
+
 #include "deserialize/simplify.hpp"
+#include "deserialize/filter.hpp"
+#include "cache.hpp"
+#include "pointer.hpp"
 
 
 namespace rcppsimdjson {
@@ -35,9 +42,77 @@ struct Parse_Opts {
     SEXP                                   empty_array;
     SEXP                                   empty_object;
     SEXP                                   single_null;
+    SEXP                                   schema        = R_NilValue;
+    R_xlen_t                               schema_sample = 0;
+    SEXP                                   select        = R_NilValue;
+    SEXP                                   filter        = R_NilValue;
+    bool                                   lazy          = false;
+    SEXP                                   spill_dir     = R_NilValue;
+    /* the document `lazy` lists deserialize from, owned by them once they're returned */
+    std::shared_ptr<simdjson::dom::document> document = nullptr;
 };
 
 
+template <Type_Policy type_policy, typename fun_T>
+inline auto dispatch_parse_opts(const utils::Int64_R_Type int64_r_type, fun_T&& fun) {
+    using Int64_R_Type = utils::Int64_R_Type;
+    constexpr auto policy = std::integral_constant<Type_Policy, type_policy>();
+
+    switch (int64_r_type) {
+        case Int64_R_Type::Double:
+            return fun(policy, std::integral_constant<Int64_R_Type, Int64_R_Type::Double>());
+
+        case Int64_R_Type::String:
+            return fun(policy, std::integral_constant<Int64_R_Type, Int64_R_Type::String>());
+
+        case Int64_R_Type::Integer64:
+            return fun(policy, std::integral_constant<Int64_R_Type, Int64_R_Type::Integer64>());
+
+        case Int64_R_Type::Always:
+            return fun(policy, std::integral_constant<Int64_R_Type, Int64_R_Type::Always>());
+    }
+
+    return fun(policy, std::integral_constant<Int64_R_Type, Int64_R_Type::Double>()); // # nocov
+}
+
+
+/**
+ * @brief Call `fun(type_policy, int64_r_type)` with `parse_opts`' run-time options as
+ * `std::integral_constant`s, for builders that only need those two template parameters.
+ */
+template <typename fun_T>
+inline auto dispatch_parse_opts(const Parse_Opts& parse_opts, fun_T&& fun) {
+    switch (parse_opts.type_policy) {
+        case Type_Policy::anything_goes:
+            return dispatch_parse_opts<Type_Policy::anything_goes>(parse_opts.int64_r_type, fun);
+
+        case Type_Policy::ints_as_dbls:
+            return dispatch_parse_opts<Type_Policy::ints_as_dbls>(parse_opts.int64_r_type, fun);
+
+        case Type_Policy::strict:
+            return dispatch_parse_opts<Type_Policy::strict>(parse_opts.int64_r_type, fun);
+    }
+
+    return dispatch_parse_opts<Type_Policy::anything_goes>(parse_opts.int64_r_type, fun); // # nocov
+}
+
+
+inline auto deserialize_filtered(const std::vector<simdjson::dom::element>& rows,
+                                 const Parse_Opts&                          parse_opts) -> SEXP;
+
+template <typename rows_T>
+inline auto deserialize_rows(const rows_T& rows, const Parse_Opts& parse_opts) -> SEXP;
+
+inline auto deserialize_lazily(simdjson::dom::element parsed, const Parse_Opts& parse_opts)
+    -> std::optional<SEXP>;
+
+inline auto deserialize_spilled(simdjson::dom::element parsed, const Parse_Opts& parse_opts)
+    -> std::optional<SEXP>;
+
+inline auto load_spilled(const std::string& path, const Parse_Opts& parse_opts)
+    -> std::optional<SEXP>;
+
+
 /**
  * @brief Deserialize a parsed  simdjson::dom::element to R objects.
  *
@@ -55,14 +130,72 @@ struct Parse_Opts {
  *
  * @param simplify_to  Simplify_To specifying the maximum level of simplification.
  *
+ * @param schema  Named integer vector of declared column types (rcpp_T), or R_NilValue. If
+ * provided, arrays are built directly into data frames of those columns. If it inherits from
+ * `json_schema`, it is instead a cached diagnosis that is verified as it is used.
+ *
+ * @param schema_sample  If positive, the columns of a data frame built from an array (or the rows a
+ * query matches) are diagnosed from its first, middle, and last `schema_sample` rows rather than
+ * all of them. Data frames nested in its rows are still diagnosed in full.
+ *
+ * @param select  Named character vector of JSON Pointers, relative to each row, or R_NilValue. If
+ * provided, data frames only have these columns, named after `names(select)`.
+ *
+ * @param filter  List of predicates (see filter_rows()), or R_NilValue. If provided, only the
+ * elements of an array that satisfy all of them are kept.
+ *
+ * @param spill_dir  A directory, or R_NilValue. If provided, the numeric, logical, and character
+ * columns of data frames are built into memory-mapped files there (see deserialize_spilled()).
+ *
+ * @param document  If `lazy`, the document `parsed` belongs to, which lazy lists keep alive (see
+ * deserialize_lazily()).
+ *
  *
  * @return The simplified R object ( SEXP ).
  */
 inline auto deserialize(simdjson::dom::element parsed, const Parse_Opts& parse_opts) -> SEXP {
     using Int64_R_Type = utils::Int64_R_Type;
 
-    auto& [simplify_to, type_policy, int64_opt, empty_array, empty_object, single_null] =
-        parse_opts;
+    auto& [simplify_to,
+           type_policy,
+           int64_opt,
+           empty_array,
+           empty_object,
+           single_null,
+           schema,
+           schema_sample,
+           select,
+           filter,
+           lazy,
+           spill_dir,
+           document] = parse_opts;
+
+    // arrays are only deserialized as rows if they need to be filtered, selected, or typed first
+    if (simdjson::dom::array array;
+        (filter != R_NilValue || select != R_NilValue || schema != R_NilValue) &&
+        parsed.get(array) == simdjson::SUCCESS) {
+        return deserialize_rows(array, parse_opts);
+    }
+
+    // spilled data frames keep their numeric and character columns in files rather than R's memory
+    if (spill_dir != R_NilValue) {
+        if (const auto out = deserialize_spilled(parsed, parse_opts)) {
+            return *out;
+        }
+    }
+
+    // lazy lists only deserialize each element when R first accesses it
+    if (document) {
+        if (const auto out = deserialize_lazily(parsed, parse_opts)) {
+            return *out;
+        }
+    }
+
+    // sampled diagnoses only apply to the rows of the array itself, not to nested data frames
+    if (simdjson::dom::array array; schema_sample > 0 && simplify_to == Simplify_To::data_frame &&
+                                    parsed.get(array) == simdjson::SUCCESS) {
+        return deserialize_rows(array, parse_opts);
+    }
 
     // THE GREAT DISPATCHER
     switch (type_policy) {
@@ -421,36 +554,285 @@ inline auto deserialize(simdjson::dom::element parsed, const Parse_Opts& parse_o
 }
 
 
+/**
+ * @brief Whether any of `rows` is an object, i.e. whether a declared schema applies to them.
+ */
+template <typename rows_T>
+inline auto has_records(const rows_T& rows) -> bool {
+    for (auto element : rows) {
+        if (element.type() == simdjson::dom::element_type::OBJECT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief Deserialize `rows` as the elements of a JSON array.
+ *
+ * `rows` is either a simdjson::dom::array or the elements matched by a wildcard or slice query
+ * (see query_and_deserialize()), so both honor `filter`, `select`, and `schema` alike.
+ */
+template <typename rows_T>
+inline auto deserialize_rows(const rows_T& rows, const Parse_Opts& parse_opts) -> SEXP {
+    // rows failing `filter` are dropped before anything is diagnosed or built
+    if (parse_opts.filter != R_NilValue) {
+        return deserialize_filtered(filter_rows(rows, parse_opts.filter), parse_opts);
+    }
+
+    const auto is_data_frame =
+        parse_opts.simplify_to == Simplify_To::data_frame && std::size(rows) != 0;
+
+    // selected columns are diagnosed and built without ever visiting other keys
+    if (parse_opts.select != R_NilValue && is_data_frame) {
+        const auto build_selected = [&rows, &parse_opts](auto policy, auto int64_r_type) {
+            return build_data_frame_selected<decltype(policy)::value,
+                                             decltype(int64_r_type)::value,
+                                             Simplify_To::data_frame>(rows,
+                                                                      parse_opts.select,
+                                                                      parse_opts.empty_array,
+                                                                      parse_opts.empty_object,
+                                                                      parse_opts.single_null);
+        };
+        if (const auto out = dispatch_parse_opts(parse_opts, build_selected)) {
+            return *out;
+        }
+    }
+
+    if (parse_opts.schema != R_NilValue && Rf_inherits(parse_opts.schema, "json_schema")) {
+        // a cached schema is only a hint, verified as the data frame is built
+        const auto build_cached = [&rows, &parse_opts](auto policy, auto int64_r_type) {
+            return build_data_frame_cached<decltype(policy)::value,
+                                           decltype(int64_r_type)::value,
+                                           Simplify_To::data_frame>(rows,
+                                                                    parse_opts.schema,
+                                                                    parse_opts.empty_array,
+                                                                    parse_opts.empty_object,
+                                                                    parse_opts.single_null);
+        };
+        if (is_data_frame) {
+            if (const auto out = dispatch_parse_opts(parse_opts, build_cached)) {
+                return *out;
+            }
+        }
+    } else if (parse_opts.schema != R_NilValue &&
+               parse_opts.simplify_to == Simplify_To::data_frame &&
+               (std::size(rows) == 0 || has_records(rows))) {
+        // a declared schema replaces `Type_Doctor` diagnosis for arrays of records, even empty ones
+        auto nested_opts   = parse_opts;
+        nested_opts.schema = R_NilValue;
+        return build_data_frame_from_schema(
+            rows, parse_opts.schema, [&nested_opts](simdjson::dom::element element) {
+                return deserialize(element, nested_opts);
+            });
+    }
+
+    // columns diagnosed from a sample are built speculatively, and rebuilt if contradicted
+    if (parse_opts.schema_sample > 0 && is_data_frame &&
+        3 * parse_opts.schema_sample < r_length(rows)) {
+        const auto build_sampled = [&rows, &parse_opts](auto policy, auto int64_r_type) {
+            return build_data_frame_sampled<decltype(policy)::value,
+                                            decltype(int64_r_type)::value,
+                                            Simplify_To::data_frame>(rows,
+                                                                     parse_opts.empty_array,
+                                                                     parse_opts.empty_object,
+                                                                     parse_opts.single_null,
+                                                                     parse_opts.schema_sample);
+        };
+        if (const auto out = dispatch_parse_opts(parse_opts, build_sampled)) {
+            return *out;
+        }
+    }
+
+    const auto simplify = [&rows, &parse_opts](auto policy, auto int64_r_type) -> SEXP {
+        constexpr auto policy_v    = decltype(policy)::value;
+        constexpr auto int64_opt_v = decltype(int64_r_type)::value;
+        const auto& [simplify_to, type_policy, int64_opt, empty_array, empty_object, single_null,
+                     schema, schema_sample, select, filter, lazy, spill_dir, document] =
+            parse_opts;
+
+        switch (simplify_to) {
+            case Simplify_To::data_frame:
+                return dispatch_simplify_array<policy_v, int64_opt_v, Simplify_To::data_frame>(
+                    rows, empty_array, empty_object, single_null);
+
+            case Simplify_To::matrix:
+                return dispatch_simplify_array<policy_v, int64_opt_v, Simplify_To::matrix>(
+                    rows, empty_array, empty_object, single_null);
+
+            case Simplify_To::vector:
+                return dispatch_simplify_array<policy_v, int64_opt_v, Simplify_To::vector>(
+                    rows, empty_array, empty_object, single_null);
+
+            case Simplify_To::list:
+                return dispatch_simplify_array<policy_v, int64_opt_v, Simplify_To::list>(
+                    rows, empty_array, empty_object, single_null);
+        }
+
+        return R_NilValue; // # nocov
+    };
+    return dispatch_parse_opts(parse_opts, simplify);
+}
+
+
+/**
+ * @brief Deserialize the rows kept by filter_rows() as if they were the whole array.
+ *
+ * Every row is an object, so they always form a data frame when `simplify_to` allows it. If none
+ * are kept, the result is `empty_array`, as for any other empty array.
+ */
+inline auto deserialize_filtered(const std::vector<simdjson::dom::element>& rows,
+                                 const Parse_Opts&                          parse_opts) -> SEXP {
+    if (std::empty(rows)) {
+        return parse_opts.empty_array;
+    }
+
+    auto nested_opts   = parse_opts;
+    nested_opts.schema = R_NilValue;
+    nested_opts.select = R_NilValue;
+    nested_opts.filter = R_NilValue;
+
+    if (parse_opts.simplify_to != Simplify_To::data_frame) {
+        auto out = Rcpp::List(std::size(rows));
+        for (std::size_t i = 0; i < std::size(rows); ++i) {
+            out[i] = deserialize(rows[i], nested_opts);
+        }
+        return out;
+    }
+
+    if (parse_opts.select != R_NilValue) {
+        const auto build_selected = [&rows, &parse_opts](auto policy, auto int64_r_type) {
+            return build_data_frame_selected<decltype(policy)::value,
+                                             decltype(int64_r_type)::value,
+                                             Simplify_To::data_frame>(rows,
+                                                                      parse_opts.select,
+                                                                      parse_opts.empty_array,
+                                                                      parse_opts.empty_object,
+                                                                      parse_opts.single_null);
+        };
+        return *dispatch_parse_opts(parse_opts, build_selected);
+    }
+
+    if (parse_opts.schema != R_NilValue && Rf_inherits(parse_opts.schema, "json_schema")) {
+        const auto build_cached = [&rows, &parse_opts](auto policy, auto int64_r_type) {
+            return build_data_frame_cached<decltype(policy)::value,
+                                           decltype(int64_r_type)::value,
+                                           Simplify_To::data_frame>(rows,
+                                                                    parse_opts.schema,
+                                                                    parse_opts.empty_array,
+                                                                    parse_opts.empty_object,
+                                                                    parse_opts.single_null);
+        };
+        return *dispatch_parse_opts(parse_opts, build_cached);
+    }
+
+    if (parse_opts.schema != R_NilValue) {
+        return build_data_frame_from_schema(
+            rows, parse_opts.schema, [&nested_opts](simdjson::dom::element element) {
+                return deserialize(element, nested_opts);
+            });
+    }
+
+    const auto build_diagnosed = [&rows, &parse_opts](auto policy, auto int64_r_type) {
+        constexpr auto policy_v    = decltype(policy)::value;
+        constexpr auto int64_opt_v = decltype(int64_r_type)::value;
+        const auto     cols        = diagnose_data_frame<policy_v, int64_opt_v>(rows);
+        return build_data_frame<policy_v, int64_opt_v, Simplify_To::data_frame>(
+            rows,
+            cols->schema,
+            parse_opts.empty_array,
+            parse_opts.empty_object,
+            parse_opts.single_null);
+    };
+    return dispatch_parse_opts(parse_opts, build_diagnosed);
+}
+
+
+/**
+ * @brief Parse `json` with `parser`, into `document` rather than the parser's own if provided.
+ */
 template <typename json_T, bool is_file>
-inline simdjson::simdjson_result<simdjson::dom::element> parse(simdjson::dom::parser& parser,
-                                                               const json_T&          json) {
+inline simdjson::simdjson_result<simdjson::dom::element>
+parse(simdjson::dom::parser&   parser,
+      const json_T&            json,
+      simdjson::dom::document* document = nullptr) {
     if constexpr (utils::resembles_vec_raw<json_T>()) {
         /* if `json` is a raw (unsigned char) vector, we can cheat */
-        return parser.parse(
-            std::string_view(reinterpret_cast<const char*>(&(json[0])), std::size(json)));
+        const auto bytes = reinterpret_cast<const char*>(&(json[0]));
+        return document ? parser.parse_into_document(*document, bytes, std::size(json))
+                        : parser.parse(std::string_view(bytes, std::size(json)));
     }
 
     if constexpr (utils::resembles_vec_chr<json_T>()) {
         /* if `json` is a character vector, we're only parsing the first element */
-        return parse<decltype(json[0]), is_file>(parser, json[0]);
+        return parse<decltype(json[0]), is_file>(parser, json[0], document);
     }
 
     if constexpr (utils::resembles_r_string<json_T>()) {
         if constexpr (is_file) { /* if `json` is a string and file path...*/
-            /* ... check for a `memDecompress()`-compatible file extension... */
+            /* ... reuse its document if `fload_cache()` is on (parsing it into the cache if not
+             * already there) and it needn't have its own... */
+            if (auto& file_cache = cache::file_cache(); file_cache.is_enabled() && !document) {
+                return file_cache.load(std::string(json), [&parser, &json](auto& document) {
+                    if (const auto file_type =
+                            utils::get_memDecompress_type(std::string_view(json))) {
+                        const auto raw = utils::decompress(std::string(json),
+                                                           Rcpp::String(std::string(*file_type)));
+                        return parser.parse_into_document(
+                            document, reinterpret_cast<const uint8_t*>(&(raw[0])), std::size(raw));
+                    }
+                    return parser.load_into_document(document, std::string(json));
+                });
+            }
+            /* ... otherwise, check for a `memDecompress()`-compatible file extension... */
             if (const auto file_type = utils::get_memDecompress_type(std::string_view(json))) {
                 return parse<Rcpp::RawVector, IS_NOT_FILE>(
                     parser, /* ... and decompress to a RawVector if so, then parse that */
-                    utils::decompress(std::string(json), Rcpp::String(std::string(*file_type))));
+                    utils::decompress(std::string(json), Rcpp::String(std::string(*file_type))),
+                    document);
             }
-            return parser.load(std::string(json)); /* otherwise, just `parser::load()` the file */
-        } else {
-            return parser.parse(std::string_view(json)); /* if not file, just parse the string */
+            /* otherwise, just `parser::load()` the file */
+            return document ? parser.load_into_document(*document, std::string(json))
+                            : parser.load(std::string(json));
+        } else { /* if not file, just parse the string */
+            const auto string = std::string_view(json);
+            return document
+                       ? parser.parse_into_document(*document, string.data(), std::size(string))
+                       : parser.parse(string);
         }
     }
 }
 
 
+/**
+ * @brief A copy of `parse_opts` with a new document for parse() to fill, if `lazy`.
+ *
+ * Lazy lists keep deserializing from their document after the parser has moved on to the next
+ * `json`, so they can't share the parser's own.
+ */
+inline auto with_own_document(const Parse_Opts& parse_opts) -> Parse_Opts {
+    auto out = parse_opts;
+    if (parse_opts.lazy) {
+        out.document = std::make_shared<simdjson::dom::document>();
+    }
+    return out;
+}
+
+
+/**
+ * @brief Deserialize every value that wildcard or slice `tokens` match, simplified like an array.
+ */
+inline SEXP fan_out_and_deserialize(simdjson::dom::element            parsed,
+                                    const std::vector<pointer::Token>& tokens,
+                                    const Parse_Opts&                  parse_opts) {
+    auto matches = std::vector<simdjson::dom::element>();
+    auto collect = [&matches](simdjson::dom::element element) { matches.push_back(element); };
+    pointer::for_each_match(parsed, tokens, 0, collect);
+    return deserialize_rows(matches, parse_opts);
+}
+
+
 template <bool query_error_ok>
 inline SEXP query_and_deserialize(simdjson::dom::element                       parsed,
                                   const Rcpp::String::const_StringProxy&       query,
@@ -465,16 +847,25 @@ inline SEXP query_and_deserialize(simdjson::dom::element                       p
         return deserialize(parsed, parse_opts);
     }
 
+    /* an extended pointer without wildcards or slices is just the plain pointer after its `$` */
+    auto path = std::string_view(query);
+    if (pointer::is_extended(path)) {
+        if (const auto tokens = pointer::tokenize(path); tokens && pointer::is_fan_out(*tokens)) {
+            return fan_out_and_deserialize(parsed, *tokens, parse_opts);
+        }
+        path.remove_prefix(1);
+    }
+
     if constexpr (query_error_ok) {
         simdjson::dom::element queried;
-        if(parsed.at_pointer(std::string_view(query)).get(queried) == simdjson::SUCCESS) {
+        if(parsed.at_pointer(path).get(queried) == simdjson::SUCCESS) {
             return deserialize(queried, parse_opts);				// #nocov
         }
         return on_query_error;
 
     } else { /* !query_error_ok */
         simdjson::dom::element queried;
-        auto error = parsed.at_pointer(std::string_view(query)).get(queried);
+        auto error = parsed.at_pointer(path).get(queried);
         if (error != simdjson::SUCCESS) {
             Rcpp::stop(simdjson::error_message(error));
         }
@@ -483,6 +874,35 @@ inline SEXP query_and_deserialize(simdjson::dom::element                       p
 }
 
 
+/**
+ * @brief Deserialize all of `query` from a single parsed document.
+ *
+ * `trie` resolves every compiled query in one traversal of `parsed`; whatever it leaves
+ * unresolved goes through query_and_deserialize(), so errors are reported exactly as before.
+ */
+template <bool query_error_ok>
+inline SEXP queries_and_deserialize(simdjson::dom::element       parsed,
+                                    const Rcpp::CharacterVector& query,
+                                    pointer::Query_Trie&         trie,
+                                    SEXP                         on_query_error,
+                                    const Parse_Opts&            parse_opts) {
+    const auto& found = trie.resolve(parsed);
+    Rcpp::List  out(std::size(query));
+    for (R_xlen_t i = 0; i < r_length(query); ++i) {
+        if (found[i]) {
+            out[i] = deserialize(*found[i], parse_opts);
+        } else if (const auto& tokens = trie.fan_out(i)) {
+            out[i] = fan_out_and_deserialize(parsed, *tokens, parse_opts);
+        } else {
+            out[i] = query_and_deserialize<query_error_ok>(
+                parsed, query[i], on_query_error, parse_opts);
+        }
+    }
+    out.attr("names") = query.attr("names");
+    return out;
+}
+
+
 template <typename json_T, bool is_file, bool parse_error_ok>
 inline SEXP parse_and_deserialize(simdjson::dom::parser&                       parser,
                                   const json_T&                                json,
@@ -492,20 +912,40 @@ inline SEXP parse_and_deserialize(simdjson::dom::parser&                       p
         return Rcpp::LogicalVector(1, NA_LOGICAL);
     }
 
+    // files of records can be streamed into spilled data frames without ever being parsed whole
+    if constexpr (is_file &&
+                  (utils::resembles_vec_chr<json_T>() || utils::resembles_r_string<json_T>())) {
+        if (parse_opts.spill_dir != R_NilValue) {
+            const auto path = [&json]() -> std::string {
+                if constexpr (utils::resembles_vec_chr<json_T>()) {
+                    return std::string(json[0]);
+                } else {
+                    return std::string(json);
+                }
+            }();
+            if (const auto out = load_spilled(path, parse_opts)) {
+                return *out;
+            }
+        }
+    }
+
+    const auto opts = with_own_document(parse_opts);
+
     if constexpr (parse_error_ok) {
         simdjson::dom::element parsed;
-        if(simdjson::SUCCESS == parse<json_T, is_file>(parser, json).get(parsed)) {
-            return deserialize(parsed, parse_opts);
+        if(simdjson::SUCCESS ==
+           parse<json_T, is_file>(parser, json, opts.document.get()).get(parsed)) {
+            return deserialize(parsed, opts);
         }
         return on_parse_error;
 
     } else {
         simdjson::dom::element parsed;
-        auto error = parse<json_T, is_file>(parser, json).get(parsed);
+        auto error = parse<json_T, is_file>(parser, json, opts.document.get()).get(parsed);
         if (error != simdjson::SUCCESS) {
             Rcpp::stop(simdjson::error_message(error));
         }
-        return deserialize(parsed, parse_opts);
+        return deserialize(parsed, opts);
     }
 }
 
@@ -520,22 +960,61 @@ inline SEXP parse_query_and_deserialize(simdjson::dom::parser&                 p
     if (utils::is_na_string(json)) {
         return Rcpp::LogicalVector(1, NA_LOGICAL);				// #nocov
     }
+    const auto opts = with_own_document(parse_opts);
 
     if constexpr (parse_error_ok) {
         simdjson::dom::element parsed;
-        if(simdjson::SUCCESS == parse<json_T, is_file>(parser, json).get(parsed)) {
-            return query_and_deserialize<query_error_ok>(parsed, query, on_query_error, parse_opts);
+        if(simdjson::SUCCESS ==
+           parse<json_T, is_file>(parser, json, opts.document.get()).get(parsed)) {
+            return query_and_deserialize<query_error_ok>(parsed, query, on_query_error, opts);
         }
         return on_parse_error;
 
     } else {
         simdjson::dom::element parsed;
-        auto error = parse<json_T, is_file>(parser, json).get(parsed);
+        auto error = parse<json_T, is_file>(parser, json, opts.document.get()).get(parsed);
         if (error != simdjson::SUCCESS) {
             Rcpp::stop(simdjson::error_message(error));
         }
-        return query_and_deserialize<query_error_ok>(parsed, query, on_query_error, parse_opts);
+        return query_and_deserialize<query_error_ok>(parsed, query, on_query_error, opts);
+    }
+}
+
+
+/**
+ * @brief For each element of `json`, the index of the first one holding the same bytes.
+ *
+ * Elements are hashed as `std::string_view`s but compared byte for byte, so colliding hashes never
+ * merge different documents. Every `NA` maps to the first `NA`.
+ */
+template <typename json_T>
+inline auto first_identical(const json_T& json) -> std::vector<R_xlen_t> {
+    const auto bytes = [&json](const R_xlen_t i) {
+        if constexpr (utils::resembles_vec_chr<json_T>()) {
+            const SEXP x = STRING_ELT(json, i);
+            return std::string_view(CHAR(x), Rf_xlength(x));
+        } else {
+            const SEXP x = VECTOR_ELT(json, i);
+            return std::string_view(reinterpret_cast<const char*>(RAW(x)), Rf_xlength(x));
+        }
+    };
+
+    const auto n        = R_xlen_t(std::size(json));
+    auto       out      = std::vector<R_xlen_t>(n);
+    auto       seen     = std::unordered_map<std::string_view, R_xlen_t>(n);
+    auto       first_na = R_xlen_t(-1);
+    for (R_xlen_t i = 0; i < n; ++i) {
+        if (utils::is_na_string(json[i])) {
+            if (first_na == -1) {
+                first_na = i;
+            }
+            out[i] = first_na;
+        } else {
+            out[i] = seen.try_emplace(bytes(i), i).first->second;
+        }
     }
+
+    return out;
 }
 
 
@@ -546,7 +1025,8 @@ template <typename json_T,
           bool query_error_ok>
 inline SEXP no_query(const json_T&                                json,
                      SEXP                                         on_parse_error,
-                     const rcppsimdjson::deserialize::Parse_Opts& parse_opts) {
+                     const rcppsimdjson::deserialize::Parse_Opts& parse_opts,
+                     const bool                                   dedupe_inputs) {
     simdjson::dom::parser parser;
 
     if constexpr (is_single_json) {
@@ -557,7 +1037,13 @@ inline SEXP no_query(const json_T&                                json,
         const R_xlen_t n = std::size(json);
         Rcpp::List     out(n);
 
+        /* identical documents are parsed once and share the same R object */
+        const auto first = dedupe_inputs ? first_identical(json) : std::vector<R_xlen_t>();
         for (R_xlen_t i = 0; i < n; ++i) {
+            if (dedupe_inputs && first[i] != i) {
+                SET_VECTOR_ELT(out, i, VECTOR_ELT(out, first[i]));
+                continue;
+            }
             out[i] = parse_and_deserialize<decltype(json[i]), is_file, parse_error_ok>(
                 parser, json[i], on_parse_error, parse_opts);
         }
@@ -568,6 +1054,38 @@ inline SEXP no_query(const json_T&                                json,
 }
 
 
+template <typename json_T, bool is_file, bool parse_error_ok, bool query_error_ok>
+inline SEXP parse_queries_and_deserialize(simdjson::dom::parser&       parser,
+                                          const json_T&                json,
+                                          const Rcpp::CharacterVector& query,
+                                          pointer::Query_Trie&         trie,
+                                          SEXP                         on_parse_error,
+                                          SEXP                         on_query_error,
+                                          const Parse_Opts&            parse_opts) {
+    const auto fill = [&query](SEXP value) {
+        Rcpp::List out(std::size(query), value);
+        out.attr("names") = query.attr("names");
+        return out;
+    };
+
+    if (utils::is_na_string(json)) {
+        return fill(Rcpp::LogicalVector(1, NA_LOGICAL));			// #nocov
+    }
+
+    const auto             opts = with_own_document(parse_opts);
+    simdjson::dom::element parsed;
+    auto error = parse<json_T, is_file>(parser, json, opts.document.get()).get(parsed);
+    if (error != simdjson::SUCCESS) {
+        if constexpr (parse_error_ok) {
+            return fill(on_parse_error);
+        } else {
+            Rcpp::stop(simdjson::error_message(error));
+        }
+    }
+    return queries_and_deserialize<query_error_ok>(parsed, query, trie, on_query_error, opts);
+}
+
+
 template <typename json_T,
           bool is_file,
           bool is_single_json,
@@ -576,44 +1094,47 @@ template <typename json_T,
           bool query_error_ok>
 inline SEXP flat_query(const json_T&                                json,
                        const Rcpp::CharacterVector&                 query,
+                       pointer::Query_Trie*                         compiled,
                        SEXP                                         on_parse_error,
                        SEXP                                         on_query_error,
-                       const rcppsimdjson::deserialize::Parse_Opts& parse_opts) {
+                       const rcppsimdjson::deserialize::Parse_Opts& parse_opts,
+                       const bool                                   dedupe_inputs) {
     simdjson::dom::parser parser;
 
+    /* a `json_pointer()` query is already compiled, others are compiled once for all of `json` */
+    auto  local_trie = std::optional<pointer::Query_Trie>();
+    auto& trie       = compiled ? *compiled : local_trie.emplace(query);
+
     if constexpr (is_single_json) {
         if constexpr (is_single_query) {
+            if (compiled) {
+                return VECTOR_ELT(
+                    parse_queries_and_deserialize<json_T, is_file, parse_error_ok, query_error_ok>(
+                        parser, json, query, trie, on_parse_error, on_query_error, parse_opts),
+                    0);
+            }
             return parse_query_and_deserialize<json_T, is_file, parse_error_ok, query_error_ok>(
                 parser, json, query[0], on_parse_error, on_query_error, parse_opts);
 
         } else { /* !single_query */
-            const R_xlen_t n = std::size(query);
-            Rcpp::List     out(n);
-
+            const auto opts = with_own_document(parse_opts);
             if constexpr (parse_error_ok) {
                 simdjson::dom::element parsed;
-                if(simdjson::SUCCESS == parse<json_T, is_file>(parser, json).get(parsed)) {
-                    for (R_xlen_t i = 0; i < n; ++i) {				// #nocov start
-                        out[i] = query_and_deserialize<query_error_ok>(
-                            parsed, query[i], on_query_error, parse_opts);
-                    }
-                    out.attr("names") = query.attr("names");
-                    return out;							// #nocov end
+                if(simdjson::SUCCESS ==
+                   parse<json_T, is_file>(parser, json, opts.document.get()).get(parsed)) {
+                    return queries_and_deserialize<query_error_ok>(		// #nocov
+                        parsed, query, trie, on_query_error, opts);
                 }
                 return on_parse_error;
 
             } else { /* !parse_error_ok */
                 simdjson::dom::element parsed;
-                auto error = parse<json_T, is_file>(parser, json).get(parsed);
+                auto error = parse<json_T, is_file>(parser, json, opts.document.get()).get(parsed);
                 if (error != simdjson::SUCCESS) {
                     Rcpp::stop(simdjson::error_message(error));
                 }
-                for (R_xlen_t i = 0; i < n; ++i) {
-                    out[i] = query_and_deserialize<query_error_ok>(
-                        parsed, query[i], on_query_error, parse_opts);
-                }
-                out.attr("names") = query.attr("names");
-                return out;
+                return queries_and_deserialize<query_error_ok>(
+                    parsed, query, trie, on_query_error, opts);
             }
         }
 
@@ -621,31 +1142,48 @@ inline SEXP flat_query(const json_T&                                json,
         const R_xlen_t n = std::size(json);
         Rcpp::List     out(n);
 
+        /* identical documents are parsed and queried once and share the same R object */
+        const auto first = dedupe_inputs ? first_identical(json) : std::vector<R_xlen_t>();
+
         if constexpr (is_single_query) {
             for (R_xlen_t i = 0; i < n; ++i) {
-                out[i] = parse_query_and_deserialize<decltype(json[i]),
-                                                     is_file,
-                                                     parse_error_ok,
-                                                     query_error_ok>(
-                    parser, json[i], query[0], on_parse_error, on_query_error, parse_opts);
+                if (dedupe_inputs && first[i] != i) {
+                    SET_VECTOR_ELT(out, i, VECTOR_ELT(out, first[i]));
+                } else if (compiled) {
+                    out[i] = VECTOR_ELT(parse_queries_and_deserialize<decltype(json[i]),
+                                                                      is_file,
+                                                                      parse_error_ok,
+                                                                      query_error_ok>(
+                                            parser,
+                                            json[i],
+                                            query,
+                                            trie,
+                                            on_parse_error,
+                                            on_query_error,
+                                            parse_opts),
+                                        0);
+                } else {
+                    out[i] = parse_query_and_deserialize<decltype(json[i]),
+                                                         is_file,
+                                                         parse_error_ok,
+                                                         query_error_ok>(
+                        parser, json[i], query[0], on_parse_error, on_query_error, parse_opts);
+                }
             }
             out.attr("names") = json.attr("names");
             return out;
 
         } else { /* !single_query */
             for (R_xlen_t i = 0; i < n; ++i) {
-                const R_xlen_t n_queries = std::size(query);
-                Rcpp::List     res(n_queries);
-
-                for (R_xlen_t j = 0; j < n_queries; ++j) {
-                    res[j] = parse_query_and_deserialize<decltype(json[i]),
-                                                         is_file,
-                                                         parse_error_ok,
-                                                         query_error_ok>(
-                        parser, json[i], query[j], on_parse_error, on_query_error, parse_opts);
+                if (dedupe_inputs && first[i] != i) {
+                    SET_VECTOR_ELT(out, i, VECTOR_ELT(out, first[i]));
+                    continue;
                 }
-                res.attr("names") = query.attr("names");
-                out[i]            = res;
+                out[i] = parse_queries_and_deserialize<decltype(json[i]),
+                                                       is_file,
+                                                       parse_error_ok,
+                                                       query_error_ok>(
+                    parser, json[i], query, trie, on_parse_error, on_query_error, parse_opts);
             }
         }
 
@@ -671,18 +1209,16 @@ inline SEXP nested_query(const json_T&                                json,
     simdjson::dom::parser parser;
 
     if constexpr (is_single_json) {
+        const auto opts = with_own_document(parse_opts);
         if constexpr (parse_error_ok) {
             simdjson::dom::element parsed;
-            if(simdjson::SUCCESS == parse<json_T, is_file>(parser, json).get(parsed)) {
+            if(simdjson::SUCCESS ==
+               parse<json_T, is_file>(parser, json, opts.document.get()).get(parsed)) {
                 for (R_xlen_t i = 0; i < n; ++i) {
-                    const R_xlen_t n_queries = std::size(query[i]);
-                    Rcpp::List     res(n_queries);
-                    for (R_xlen_t j = 0; j < n_queries; ++j) {
-                        res[j] = query_and_deserialize<query_error_ok>(
-                            parsed, query[i][j], on_query_error, parse_opts);
-                    }
-                    res.attr("names") = query[i].attr("names");
-                    out[i]            = res;
+                    const auto queries = Rcpp::CharacterVector(query[i]);
+                    auto       trie    = pointer::Query_Trie(queries);
+                    out[i]             = queries_and_deserialize<query_error_ok>(
+                        parsed, queries, trie, on_query_error, opts);
                 }
             }
 
@@ -690,51 +1226,43 @@ inline SEXP nested_query(const json_T&                                json,
 
         } else { /* !parse_error_ok */
             simdjson::dom::element parsed;
-            auto error = parse<json_T, is_file>(parser, json).get(parsed); // #nocov
+            auto error =
+                parse<json_T, is_file>(parser, json, opts.document.get()).get(parsed); // #nocov
             if (error != simdjson::SUCCESS) {
                 Rcpp::stop(simdjson::error_message(error));			// #nocov
             }
             for (R_xlen_t i = 0; i < n; ++i) {
-                const R_xlen_t n_queries = std::size(query[i]);
-                Rcpp::List     res(n_queries);
-                for (R_xlen_t j = 0; j < n_queries; ++j) {
-                    res[j] = query_and_deserialize<query_error_ok>(
-                        parsed, query[i][j], on_query_error, parse_opts);
-                }
-                res.attr("names") = query[i].attr("names");
-                out[i]            = res;
+                const auto queries = Rcpp::CharacterVector(query[i]);
+                auto       trie    = pointer::Query_Trie(queries);
+                out[i]             = queries_and_deserialize<query_error_ok>(
+                    parsed, queries, trie, on_query_error, opts);
             }
         }
 
     } else { /* !is_single_json */
         for (R_xlen_t i = 0; i < n; ++i) {
-            const R_xlen_t n_queries = std::size(query[i]);
+            const auto queries = Rcpp::CharacterVector(query[i]);
+            const auto opts    = with_own_document(parse_opts);
             if constexpr (parse_error_ok) {
                 simdjson::dom::element parsed;
-                if(simdjson::SUCCESS == parse<decltype(json[i]), is_file>(parser, json[i]).get(parsed)) {
-                    Rcpp::List res(n_queries);						// #nocov start
-                    for (R_xlen_t j = 0; j < n_queries; ++j) {
-                        res[j] = query_and_deserialize<query_error_ok>(
-                            parsed, query[i][j], on_query_error, parse_opts);
-                    }
-                    res.attr("names") = query[i].attr("names");
-                    out[i]            = res;						// #nocov end
+                if(simdjson::SUCCESS ==
+                   parse<decltype(json[i]), is_file>(parser, json[i], opts.document.get()).get(parsed)) {
+                    auto trie = pointer::Query_Trie(queries);				// #nocov start
+                    out[i]    = queries_and_deserialize<query_error_ok>(
+                        parsed, queries, trie, on_query_error, opts);		// #nocov end
                 }
                 out[i] = on_parse_error;
 
             } else { /* !parse_error_ok */
                 simdjson::dom::element parsed;
-                auto error = parse<decltype(json[i]), is_file>(parser, json[i]).get(parsed);
+                auto error =
+                    parse<decltype(json[i]), is_file>(parser, json[i], opts.document.get()).get(parsed);
                 if (error != simdjson::SUCCESS) {
                     Rcpp::stop(simdjson::error_message(error));
                 }
-                Rcpp::List res(n_queries);
-                for (R_xlen_t j = 0; j < n_queries; ++j) {
-                    res[j] = query_and_deserialize<query_error_ok>(
-                        parsed, query[i][j], on_query_error, parse_opts);
-                }
-                res.attr("names") = query[i].attr("names");
-                out[i]            = res;
+                auto trie = pointer::Query_Trie(queries);
+                out[i]    = queries_and_deserialize<query_error_ok>(
+                    parsed, queries, trie, on_query_error, opts);
             }
         }
     }
@@ -753,8 +1281,19 @@ template <bool is_file,
           bool is_single_query,
           bool parse_error_ok,
           bool query_error_ok>
-inline SEXP dispatch_deserialize(
-    SEXP json, SEXP query, SEXP on_parse_error, SEXP on_query_error, const Parse_Opts& parse_opts) {
+inline SEXP dispatch_deserialize(SEXP              json,
+                                 SEXP              query,
+                                 SEXP              on_parse_error,
+                                 SEXP              on_query_error,
+                                 const Parse_Opts& parse_opts,
+                                 const bool        dedupe_inputs) {
+
+    /* a `json_pointer()` query is its compiled Query_Trie, with the original queries attached */
+    auto compiled = static_cast<pointer::Query_Trie*>(nullptr);
+    if (TYPEOF(query) == EXTPTRSXP) {
+        compiled = static_cast<pointer::Query_Trie*>(R_ExternalPtrAddr(query));
+        query    = Rf_getAttrib(query, Rf_install("query"));
+    }
 
     switch (TYPEOF(json)) {
         case STRSXP: {
@@ -764,7 +1303,8 @@ inline SEXP dispatch_deserialize(
                                     is_file,
                                     is_single_json,
                                     parse_error_ok,
-                                    query_error_ok>(json, on_parse_error, parse_opts);
+                                    query_error_ok>(
+                        json, on_parse_error, parse_opts, dedupe_inputs);
 
                 case STRSXP:
                     return flat_query<Rcpp::CharacterVector,
@@ -773,7 +1313,13 @@ inline SEXP dispatch_deserialize(
                                       is_single_query,
                                       parse_error_ok,
                                       query_error_ok>(
-                        json, query, on_parse_error, on_query_error, parse_opts);
+                        json,
+                        query,
+                        compiled,
+                        on_parse_error,
+                        on_query_error,
+                        parse_opts,
+                        dedupe_inputs);
 
                 case VECSXP:
                     return nested_query<Rcpp::CharacterVector,
@@ -796,7 +1342,8 @@ inline SEXP dispatch_deserialize(
                                     is_file,
                                     SINGLE_JSON, /* RAWSXP json must be SINGLE_JSON */
                                     parse_error_ok,
-                                    query_error_ok>(json, on_parse_error, parse_opts);
+                                    query_error_ok>(
+                        json, on_parse_error, parse_opts, dedupe_inputs);
 
                 case STRSXP:
                     return flat_query<Rcpp::RawVector,
@@ -805,7 +1352,13 @@ inline SEXP dispatch_deserialize(
                                       is_single_query,
                                       parse_error_ok,
                                       query_error_ok>(
-                        json, query, on_parse_error, on_query_error, parse_opts);
+                        json,
+                        query,
+                        compiled,
+                        on_parse_error,
+                        on_query_error,
+                        parse_opts,
+                        dedupe_inputs);
 
                 case VECSXP:								// #nocov start
                     return nested_query<Rcpp::RawVector,
@@ -828,7 +1381,8 @@ inline SEXP dispatch_deserialize(
                                     is_file,
                                     NOT_SINGLE_JSON, /* VECSXP json always NOT_SINGLE_JSON */
                                     parse_error_ok,
-                                    query_error_ok>(json, on_parse_error, parse_opts);
+                                    query_error_ok>(
+                        json, on_parse_error, parse_opts, dedupe_inputs);
 
                 case STRSXP:
                     return flat_query<Rcpp::ListOf<Rcpp::RawVector>,
@@ -837,7 +1391,13 @@ inline SEXP dispatch_deserialize(
                                       is_single_query,
                                       parse_error_ok,
                                       query_error_ok>(
-                        json, query, on_parse_error, on_query_error, parse_opts);
+                        json,
+                        query,
+                        compiled,
+                        on_parse_error,
+                        on_query_error,
+                        parse_opts,
+                        dedupe_inputs);
 
                 case VECSXP:							// #nocov start
                     return nested_query<Rcpp::ListOf<Rcpp::RawVector>,
@@ -872,13 +1432,26 @@ inline SEXP start(SEXP       json,
                   SEXP       on_query_error,
                   const int  simplify_to,
                   const int  type_policy,
-                  const int  int64_r_type) {
+                  const int  int64_r_type,
+                  SEXP       schema,
+                  const int  schema_sample,
+                  SEXP       select,
+                  SEXP       filter,
+                  const bool dedupe_inputs,
+                  const bool lazy,
+                  SEXP       spill_dir) {
     const auto parse_opts = Parse_Opts{static_cast<Simplify_To>(simplify_to),
                                        static_cast<Type_Policy>(type_policy),
                                        static_cast<utils::Int64_R_Type>(int64_r_type),
                                        empty_array,
                                        empty_object,
-                                       single_null};
+                                       single_null,
+                                       schema,
+                                       schema_sample,
+                                       select,
+                                       filter,
+                                       lazy,
+                                       spill_dir};
 
     if (parse_error_ok) {
         return query_error_ok ? dispatch_deserialize<is_file,
@@ -886,26 +1459,46 @@ inline SEXP start(SEXP       json,
                                                      is_single_query,
                                                      PARSE_ERROR_OK,
                                                      QUERY_ERROR_OK>(
-                                    json, query, on_parse_error, on_query_error, parse_opts)
+                                    json,
+                                    query,
+                                    on_parse_error,
+                                    on_query_error,
+                                    parse_opts,
+                                    dedupe_inputs)
                               : dispatch_deserialize<is_file,
                                                      is_single_json,
                                                      is_single_query,
                                                      PARSE_ERROR_OK,
                                                      QUERY_ERROR_NOT_OK>(
-                                    json, query, on_parse_error, on_query_error, parse_opts);
+                                    json,
+                                    query,
+                                    on_parse_error,
+                                    on_query_error,
+                                    parse_opts,
+                                    dedupe_inputs);
     } else { /* !parse_error_ok*/
         return query_error_ok ? dispatch_deserialize<is_file,
                                                      is_single_json,
                                                      is_single_query,
                                                      PARSE_ERROR_NOT_OK,
                                                      QUERY_ERROR_OK>(
-                                    json, query, on_parse_error, on_query_error, parse_opts)
+                                    json,
+                                    query,
+                                    on_parse_error,
+                                    on_query_error,
+                                    parse_opts,
+                                    dedupe_inputs)
                               : dispatch_deserialize<is_file,
                                                      is_single_json,
                                                      is_single_query,
                                                      PARSE_ERROR_NOT_OK,
                                                      QUERY_ERROR_NOT_OK>(
-                                    json, query, on_parse_error, on_query_error, parse_opts);
+                                    json,
+                                    query,
+                                    on_parse_error,
+                                    on_query_error,
+                                    parse_opts,
+                                    dedupe_inputs);
     }
 }
 
@@ -914,4 +1507,8 @@ inline SEXP start(SEXP       json,
 } // namespace rcppsimdjson
 
 
+#include "lazy.hpp"  /* defines deserialize_lazily(), which needs all of the above */
+#include "spill.hpp" /* defines deserialize_spilled() and load_spilled(), likewise */
+
+
 #endif
@@ -40,7 +40,9 @@ class Type_Doctor {
 
   public:
     Type_Doctor() = default;
-    explicit Type_Doctor(simdjson::dom::array) noexcept;
+    template <typename array_T>
+    explicit Type_Doctor(const array_T&) noexcept;
+    explicit constexpr Type_Doctor(rcpp_T) noexcept;
 
     [[nodiscard]] constexpr auto has_null() const noexcept -> bool { return null_; };
 
@@ -52,13 +54,15 @@ class Type_Doctor {
     [[nodiscard]] constexpr auto is_vectorizable() const noexcept -> bool;
 
     auto add_element(simdjson::dom::element) noexcept -> void;
+    [[nodiscard]] auto has_seen(simdjson::dom::element) const noexcept -> bool;
 
     constexpr auto update(Type_Doctor<type_policy, int64_opt>&&) noexcept -> void;
 };
 
 
 template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
-inline Type_Doctor<type_policy, int64_opt>::Type_Doctor(simdjson::dom::array array) noexcept {
+template <typename array_T>
+inline Type_Doctor<type_policy, int64_opt>::Type_Doctor(const array_T& array) noexcept {
     for (auto element : array) {
         switch (element.type()) {
             case simdjson::dom::element_type::ARRAY:
@@ -114,6 +118,53 @@ inline Type_Doctor<type_policy, int64_opt>::Type_Doctor(simdjson::dom::array arr
 }
 
 
+// a diagnosis as if only elements of `R_Type` had been seen, e.g. to resume from a cached schema
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline constexpr Type_Doctor<type_policy, int64_opt>::Type_Doctor(const rcpp_T R_Type) noexcept {
+    switch (R_Type) {
+        case rcpp_T::array:
+            ARRAY_ = array_ = true;
+            break;
+
+        case rcpp_T::object:
+            OBJECT_ = object_ = true;
+            break;
+
+        case rcpp_T::chr:
+            STRING_ = chr_ = true;
+            break;
+
+        case rcpp_T::u64:
+            UINT64_ = u64_ = true;
+            break;
+
+        case rcpp_T::dbl:
+            DOUBLE_ = dbl_ = true;
+            break;
+
+        case rcpp_T::i64:
+            INT64_ = i64_ = true;
+            break;
+
+        case rcpp_T::i32:
+            if constexpr (int64_opt == utils::Int64_R_Type::Always) {
+                INT64_ = i64_ = true;
+            } else {
+                INT64_ = i32_ = true;
+            }
+            break;
+
+        case rcpp_T::lgl:
+            BOOL_ = lgl_ = true;
+            break;
+
+        case rcpp_T::null:
+            NULL_VALUE_ = null_ = true;
+            break;
+    }
+}
+
+
 template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
 constexpr bool Type_Doctor<type_policy, int64_opt>::is_homogeneous() const noexcept {
     if (ARRAY_) {
@@ -312,6 +363,45 @@ void Type_Doctor<type_policy, int64_opt>::add_element(simdjson::dom::element ele
 }
 
 
+// true if `add_element(element)` would leave the diagnosis unchanged
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline bool
+Type_Doctor<type_policy, int64_opt>::has_seen(simdjson::dom::element element) const noexcept {
+    switch (element.type()) {
+        case simdjson::dom::element_type::ARRAY:
+            return ARRAY_;
+
+        case simdjson::dom::element_type::OBJECT:
+            return OBJECT_;
+
+        case simdjson::dom::element_type::STRING:
+            return STRING_;
+
+        case simdjson::dom::element_type::DOUBLE:
+            return DOUBLE_;
+
+        case simdjson::dom::element_type::INT64: {
+            if constexpr (int64_opt == utils::Int64_R_Type::Always) {
+                return i64_;
+            } else {
+                return utils::is_castable_int64(int64_t(element)) ? i32_ : i64_;
+            }
+        }
+
+        case simdjson::dom::element_type::BOOL:
+            return BOOL_;
+
+        case simdjson::dom::element_type::NULL_VALUE:
+            return NULL_VALUE_;
+
+        case simdjson::dom::element_type::UINT64:
+            return UINT64_;
+    }
+
+    return false; // # nocov
+}
+
+
 template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
 inline constexpr void Type_Doctor<type_policy, int64_opt>::update(
     Type_Doctor<type_policy, int64_opt>&& type_doctor2) noexcept {
@@ -3,6 +3,7 @@
 
 
 #include "RcppSimdJson/utils.hpp"
+#include "RcppSimdJson/compact.hpp"
 #include "matrix.hpp"
 
 
@@ -21,9 +22,24 @@ struct Column_Schema {
         std::unordered_map<std::string_view, Column<type_policy, int64_opt>>();
 };
 
+/**
+ * @brief A column found by a JSON Pointer relative to each row, rather than by one of its keys.
+ */
+struct Column_Pointer {
+    std::string_view pointer;
+};
 
-template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
-inline auto diagnose_data_frame(simdjson::dom::array array) noexcept(RCPPSIMDJSON_NO_EXCEPTIONS)
+inline auto lookup(simdjson::dom::element row, const std::string_view key) {
+    return row.get_object().at_key(key);
+}
+
+inline auto lookup(simdjson::dom::element row, const Column_Pointer column_pointer) {
+    return row.at_pointer(column_pointer.pointer);
+}
+
+
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, typename rows_T>
+inline auto diagnose_data_frame(const rows_T& array) noexcept(RCPPSIMDJSON_NO_EXCEPTIONS)
     -> std::optional<Column_Schema<type_policy, int64_opt>> {
     // if (std::size(array) == 0) { // already handled in `dispatch_simplify_array()`
     //     return std::nullopt;
@@ -51,23 +67,30 @@ inline auto diagnose_data_frame(simdjson::dom::array array) noexcept(RCPPSIMDJSO
 }
 
 
+/**
+ * @brief Fill `out`, anything indexed like an `Rcpp::Vector<RTYPE>` whose elements are already NA,
+ * with the values of each row's `key`.
+ */
 template <int RTYPE,
           typename scalar_T,
           rcpp_T              R_Type,
           Type_Policy         type_policy,
-          utils::Int64_R_Type int64_opt>
-inline auto build_col(simdjson::dom::array                       array,
-                      const std::string_view                     key,
-                      const Type_Doctor<type_policy, int64_opt>& type_doc) -> Rcpp::Vector<RTYPE> {
+          utils::Int64_R_Type int64_opt,
+          typename rows_T,
+          typename key_T,
+          typename out_T>
+inline void fill_col(const rows_T&                              array,
+                     const key_T                                key,
+                     const Type_Doctor<type_policy, int64_opt>& type_doc,
+                     out_T&                                     out) {
 
-    auto out   = Rcpp::Vector<RTYPE>(std::size(array), na_val<R_Type>());
     auto i_row = R_xlen_t(0L);
 
     if (type_doc.is_homogeneous()) {
         if (type_doc.has_null()) {
             for (auto object : array) {
                 simdjson::dom::element element;
-                if(object.get_object().at_key(key).get(element) == simdjson::SUCCESS) {
+                if(lookup(object, key).get(element) == simdjson::SUCCESS) {
                     out[i_row] = get_scalar<scalar_T, R_Type, HAS_NULLS>(element);
                 }
                 i_row++;
@@ -77,7 +100,7 @@ inline auto build_col(simdjson::dom::array                       array,
 
             for (auto object : array) {
                 simdjson::dom::element element;
-                if(object.get_object().at_key(key).get(element) == simdjson::SUCCESS) {
+                if(lookup(object, key).get(element) == simdjson::SUCCESS) {
                     out[i_row] = get_scalar<scalar_T, R_Type, NO_NULLS>(element);
                 }
                 i_row++;
@@ -88,20 +111,99 @@ inline auto build_col(simdjson::dom::array                       array,
 
         for (auto object : array) {
             simdjson::dom::element element;
-            if(object.get_object().at_key(key).get(element) == simdjson::SUCCESS) {
+            if(lookup(object, key).get(element) == simdjson::SUCCESS) {
                 out[i_row] = get_scalar_dispatch<RTYPE>(element);
             }
             i_row++;
         }
     }
+}
 
+
+template <int RTYPE,
+          typename scalar_T,
+          rcpp_T              R_Type,
+          Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          typename rows_T,
+          typename key_T>
+inline auto build_col(const rows_T&                              array,
+                      const key_T                                key,
+                      const Type_Doctor<type_policy, int64_opt>& type_doc) -> Rcpp::Vector<RTYPE> {
+
+    auto out = Rcpp::Vector<RTYPE>(std::size(array), na_val<R_Type>());
+    fill_col<RTYPE, scalar_T, R_Type>(array, key, type_doc, out);
     return out;
 }
 
 
-template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
-inline auto build_col_integer64(simdjson::dom::array                      array,
-                                const std::string_view                    key,
+/**
+ * @brief Fill `out` like fill_col() does, but with the bits of `bit64::integer64` values.
+ */
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          typename rows_T,
+          typename key_T,
+          typename out_T>
+inline void fill_col_integer64(const rows_T&                              array,
+                               const key_T                                key,
+                               const Type_Doctor<type_policy, int64_opt>& type_doc,
+                               out_T&                                     out) {
+    auto i_row = R_xlen_t(0L);
+
+    if (type_doc.is_homogeneous()) {
+        if (type_doc.has_null()) {
+            for (auto object : array) {
+                simdjson::dom::element element;
+                if(lookup(object, key).get(element) == simdjson::SUCCESS) {
+                    out[i_row] = utils::int64_bits(
+                        get_scalar<int64_t, rcpp_T::i64, HAS_NULLS>(element));
+                }
+                i_row++;
+            }
+
+        } else {
+            for (auto object : array) {
+                simdjson::dom::element element;
+                if(lookup(object, key).get(element) == simdjson::SUCCESS) {
+                    out[i_row] = utils::int64_bits(
+                        get_scalar<int64_t, rcpp_T::i64, NO_NULLS>(element));
+                }
+                i_row++;
+            }
+        }
+
+    } else {
+        for (auto object : array) {
+            simdjson::dom::element element;
+            if(lookup(object, key).get(element) == simdjson::SUCCESS) {
+                switch (element.type()) {
+                    case simdjson::dom::element_type::INT64:
+                        out[i_row] = utils::int64_bits(
+                            get_scalar<int64_t, rcpp_T::i64, NO_NULLS>(element));
+                        break;
+
+                    case simdjson::dom::element_type::BOOL:
+                        out[i_row] = utils::int64_bits(
+                            get_scalar<bool, rcpp_T::i64, NO_NULLS>(element));
+                        break;
+
+                    default:					// #nocov
+                        break;					// #nocov
+                }
+            }
+            i_row++;
+        }
+    }
+}
+
+
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          typename rows_T,
+          typename key_T>
+inline auto build_col_integer64(const rows_T&                             array,
+                                const key_T                               key,
                                 const Type_Doctor<type_policy, int64_opt> type_doc) -> SEXP {
 
     if constexpr (int64_opt == utils::Int64_R_Type::Double) {
@@ -114,57 +216,98 @@ inline auto build_col_integer64(simdjson::dom::array                      array,
 
     if constexpr (int64_opt == utils::Int64_R_Type::Integer64 ||
                   int64_opt == utils::Int64_R_Type::Always) {
-        auto stl_vec = std::vector<int64_t>(std::size(array), NA_INTEGER64);
-        auto i_row   = std::size_t(0ULL);
-
-        if (type_doc.is_homogeneous()) {
-            if (type_doc.has_null()) {
-                for (auto object : array) {
-                    simdjson::dom::element element;
-                    if(object.get_object().at_key(key).get(element) == simdjson::SUCCESS) {
-                        stl_vec[i_row] = get_scalar<int64_t, rcpp_T::i64, HAS_NULLS>(element);
-                    }
-                    i_row++;
-                }
+        auto out = Rcpp::NumericVector(std::size(array), utils::int64_bits(NA_INTEGER64));
+        fill_col_integer64(array, key, type_doc, out);
+        return utils::as_integer64(out);
+    }
+}
 
-            } else {
-                for (auto object : array) {
-                    simdjson::dom::element element;
-                    if(object.get_object().at_key(key).get(element) == simdjson::SUCCESS) {
-                        stl_vec[i_row] = get_scalar<int64_t, rcpp_T::i64, NO_NULLS>(element);
-                    }
-                    i_row++;
-                }
-            }
 
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename rows_T,
+          typename key_T>
+inline auto build_col_list(const rows_T&          array,
+                           const key_T            key,
+                           R_xlen_t&              n_found,
+                           SEXP                   empty_array,
+                           SEXP                   empty_object,
+                           SEXP                   single_null) -> SEXP {
+
+    auto out   = Rcpp::Vector<VECSXP>(r_length(array));
+    auto i_row = R_xlen_t(0L);
+
+    for (auto element : array) {
+        simdjson::dom::element value;
+        if(lookup(element, key).get(value) == simdjson::SUCCESS) {
+            out[i_row++] = simplify_element<type_policy, int64_opt, simplify_to>(
+                value, empty_array, empty_object, single_null);
+            n_found++;
         } else {
-            for (auto object : array) {
-                simdjson::dom::element element;
-                if(object.get_object().at_key(key).get(element) == simdjson::SUCCESS) {
-                    switch (element.type()) {
-                        case simdjson::dom::element_type::INT64:
-                            stl_vec[i_row] = get_scalar<int64_t, rcpp_T::i64, NO_NULLS>(element);
-                            break;
-
-                        case simdjson::dom::element_type::BOOL:
-                            stl_vec[i_row] = get_scalar<bool, rcpp_T::i64, NO_NULLS>(element);
-                            break;
-
-                        default:					// #nocov
-                            break;					// #nocov
-                    }
-                }
-                i_row++;
-            }
+            out[i_row++] = NA_LOGICAL;
         }
-        return utils::as_integer64(stl_vec);
     }
+
+    return out;
 }
 
 
-template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, Simplify_To simplify_to>
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename rows_T,
+          typename key_T>
+inline auto build_column(const rows_T&                              array,
+                         const key_T                                key,
+                         const Type_Doctor<type_policy, int64_opt>& type_doc,
+                         SEXP                                       empty_array,
+                         SEXP                                       empty_object,
+                         SEXP                                       single_null) -> SEXP {
+
+    switch (type_doc.common_R_type()) {
+        case rcpp_T::chr:
+            return compact::compact(
+                build_col<STRSXP, std::string, rcpp_T::chr, type_policy>(array, key, type_doc));
+
+        case rcpp_T::dbl:
+            return compact::compact(
+                build_col<REALSXP, double, rcpp_T::dbl, type_policy>(array, key, type_doc));
+
+        case rcpp_T::i64:
+            return compact::compact(
+                build_col_integer64<type_policy, int64_opt>(array, key, type_doc));
+
+        case rcpp_T::i32:
+            return compact::compact(
+                build_col<INTSXP, int64_t, rcpp_T::i32, type_policy>(array, key, type_doc));
+
+        case rcpp_T::lgl:
+            return compact::compact(
+                build_col<LGLSXP, bool, rcpp_T::lgl, type_policy>(array, key, type_doc));
+
+        case rcpp_T::null:
+            return compact::compact(Rcpp::LogicalVector(r_length(array), NA_LOGICAL));
+
+        case rcpp_T::u64:
+            return compact::compact(
+                build_col<STRSXP, uint64_t, rcpp_T::chr, type_policy>(array, key, type_doc));
+
+        default: {
+            auto n_found = R_xlen_t(0L);
+            return build_col_list<type_policy, int64_opt, simplify_to>(
+                array, key, n_found, empty_array, empty_object, single_null);
+        }
+    }
+}
+
+
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename rows_T>
 inline auto
-build_data_frame(simdjson::dom::array                                                        array,
+build_data_frame(const rows_T&                                                               array,
                  const std::unordered_map<std::string_view, Column<type_policy, int64_opt>>& cols,
                  SEXP empty_array,
                  SEXP empty_object,
@@ -176,68 +319,538 @@ build_data_frame(simdjson::dom::array
 
     for (auto&& [key, col] : cols) {
         out_names[col.index] = Rcpp::String(std::string(key));
+        out[col.index]       = build_column<type_policy, int64_opt, simplify_to>(
+            array, key, col.schema, empty_array, empty_object, single_null);
+    }
 
-        switch (col.schema.common_R_type()) {
-            case rcpp_T::chr: {
-                out[col.index] = build_col<STRSXP, std::string, rcpp_T::chr, type_policy>(
-                    array, key, col.schema);
-                break;
-            }
+    out.attr("names")     = out_names;
+    out.attr("row.names") = Rcpp::seq_len(n_rows); /* `Rcpp::seq()` throws if `n_rows == 0` */
+    out.attr("class")     = "data.frame";
 
-            case rcpp_T::dbl: {
-                out[col.index] =
-                    build_col<REALSXP, double, rcpp_T::dbl, type_policy>(array, key, col.schema);
-                break;
-            }
+    return out;
+}
+
+
+// declared schemas ================================================================================
+/**
+ * @brief Convert a scalar to a type declared up front, rather than one diagnosed by Type_Doctor.
+ *
+ * Only lossless conversions are made; anything else (including nested arrays and objects, and
+ * integers a double can't hold exactly) becomes the declared type's NA.
+ */
+template <rcpp_T R_Type>
+inline auto get_declared_scalar(simdjson::dom::element element) {
+    if constexpr (R_Type == rcpp_T::chr) {
+        return get_scalar_dispatch<STRSXP>(element);
+    }
+
+    if constexpr (R_Type == rcpp_T::dbl) {
+        switch (element.type()) {
+            case simdjson::dom::element_type::INT64:
+                return utils::is_exact_double(int64_t(element))
+                           ? static_cast<double>(int64_t(element))
+                           : NA_REAL;
+
+            case simdjson::dom::element_type::UINT64:
+                return utils::is_exact_double(uint64_t(element))
+                           ? static_cast<double>(uint64_t(element))
+                           : NA_REAL;
+
+            default:
+                return get_scalar_dispatch<REALSXP>(element);
+        }
+    }
+
+    if constexpr (R_Type == rcpp_T::i64) {
+        switch (element.type()) {
+            case simdjson::dom::element_type::INT64:
+                return get_scalar<int64_t, rcpp_T::i64, NO_NULLS>(element);
+
+            case simdjson::dom::element_type::BOOL:
+                return get_scalar<bool, rcpp_T::i64, NO_NULLS>(element);
+
+            default:
+                return NA_INTEGER64;
+        }
+    }
+
+    if constexpr (R_Type == rcpp_T::i32) {
+        switch (element.type()) {
+            case simdjson::dom::element_type::INT64:
+                return utils::is_castable_int64(int64_t(element))
+                           ? get_scalar<int64_t, rcpp_T::i32, NO_NULLS>(element)
+                           : NA_INTEGER;
+
+            case simdjson::dom::element_type::BOOL:
+                return get_scalar<bool, rcpp_T::i32, NO_NULLS>(element);
+
+            default:
+                return NA_INTEGER;
+        }
+    }
+
+    if constexpr (R_Type == rcpp_T::lgl) {
+        return get_scalar_dispatch<LGLSXP>(element);
+    }
+}
+
+
+template <int RTYPE, rcpp_T R_Type, typename rows_T>
+inline auto build_col_declared(const rows_T& array, const std::string_view key)
+    -> Rcpp::Vector<RTYPE> {
+
+    auto out   = Rcpp::Vector<RTYPE>(std::size(array), na_val<R_Type>());
+    auto i_row = R_xlen_t(0L);
+
+    for (auto element : array) {
+        simdjson::dom::object  object;
+        simdjson::dom::element value;
+        if (element.get(object) == simdjson::SUCCESS &&
+            object.at_key(key).get(value) == simdjson::SUCCESS) {
+            out[i_row] = get_declared_scalar<R_Type>(value);
+        }
+        i_row++;
+    }
+
+    return out;
+}
+
+
+template <typename rows_T>
+inline auto build_col_declared_integer64(const rows_T& array, const std::string_view key)
+    -> SEXP {
+
+    auto out   = Rcpp::NumericVector(std::size(array), utils::int64_bits(NA_INTEGER64));
+    auto i_row = R_xlen_t(0L);
+
+    for (auto element : array) {
+        simdjson::dom::object  object;
+        simdjson::dom::element value;
+        if (element.get(object) == simdjson::SUCCESS &&
+            object.at_key(key).get(value) == simdjson::SUCCESS) {
+            out[i_row] = utils::int64_bits(get_declared_scalar<rcpp_T::i64>(value));
+        }
+        i_row++;
+    }
+
+    return utils::as_integer64(out);
+}
+
+
+/**
+ * @brief Build a data frame whose columns and types are declared by `schema`.
+ *
+ * Skips diagnose_data_frame() entirely. Keys not in `schema` are never visited, missing keys and
+ * non-conforming values become NA, and elements of `array` that aren't objects become rows of NAs.
+ *
+ * @param schema  Named integer vector of rcpp_T codes, one per column. rcpp_T::array declares a
+ * list column, whose elements are deserialized by `nested`.
+ */
+template <typename rows_T, typename nested_fun_T>
+inline auto build_data_frame_from_schema(const rows_T&              array,
+                                         const Rcpp::IntegerVector& schema,
+                                         nested_fun_T&&             nested) -> SEXP {
+
+    const auto n_rows    = R_xlen_t(std::size(array));
+    const auto n_cols    = R_xlen_t(std::size(schema));
+    auto       out       = Rcpp::List(n_cols);
+    const auto out_names = Rcpp::CharacterVector(schema.attr("names"));
+
+    for (R_xlen_t j = 0; j < n_cols; ++j) {
+        const auto key = std::string_view(CHAR(STRING_ELT(out_names, j)));
 
-            case rcpp_T::i64: {
-                out[col.index] =
-                    build_col_integer64<type_policy, int64_opt>(array, key, col.schema);
+        switch (static_cast<rcpp_T>(schema[j])) {
+            case rcpp_T::chr:
+                out[j] = compact::compact(build_col_declared<STRSXP, rcpp_T::chr>(array, key));
                 break;
-            }
 
-            case rcpp_T::i32: {
-                out[col.index] =
-                    build_col<INTSXP, int64_t, rcpp_T::i32, type_policy>(array, key, col.schema);
+            case rcpp_T::dbl:
+                out[j] = compact::compact(build_col_declared<REALSXP, rcpp_T::dbl>(array, key));
                 break;
-            }
 
-            case rcpp_T::lgl: {
-                out[col.index] =
-                    build_col<LGLSXP, bool, rcpp_T::lgl, type_policy>(array, key, col.schema);
+            case rcpp_T::i64:
+                out[j] = build_col_declared_integer64(array, key);
                 break;
-            }
 
-            case rcpp_T::null: {
-                out[col.index] = Rcpp::LogicalVector(n_rows, NA_LOGICAL);
+            case rcpp_T::i32:
+                out[j] = compact::compact(build_col_declared<INTSXP, rcpp_T::i32>(array, key));
                 break;
-            }
 
-            case rcpp_T::u64: {
-                out[col.index] =
-                    build_col<STRSXP, uint64_t, rcpp_T::chr, type_policy>(array, key, col.schema);
+            case rcpp_T::lgl:
+                out[j] = compact::compact(build_col_declared<LGLSXP, rcpp_T::lgl>(array, key));
                 break;
-            }
 
             default: {
                 auto this_col = Rcpp::Vector<VECSXP>(n_rows);
                 auto i_row    = R_xlen_t(0L);
                 for (auto element : array) {
-                    simdjson::dom::element lookup;
-                    if(element.get_object().at_key(key).get(lookup) == simdjson::SUCCESS) {
-                        this_col[i_row++] = simplify_element<type_policy, int64_opt, simplify_to>(
-                            lookup, empty_array, empty_object, single_null);
+                    simdjson::dom::object  object;
+                    simdjson::dom::element value;
+                    if (element.get(object) == simdjson::SUCCESS &&
+                        object.at_key(key).get(value) == simdjson::SUCCESS) {
+                        this_col[i_row++] = nested(value);
                     } else {
                         this_col[i_row++] = NA_LOGICAL;
                     }
                 }
-                out[col.index] = this_col;
+                out[j] = this_col;
             }
         }
     }
 
     out.attr("names")     = out_names;
-    out.attr("row.names") = Rcpp::seq(1, n_rows);
+    out.attr("row.names") = Rcpp::seq_len(n_rows); /* `Rcpp::seq()` throws if `n_rows == 0` */
+    out.attr("class")     = "data.frame";
+
+    return out;
+}
+
+
+// sampled schemas =================================================================================
+/**
+ * @brief Diagnose a data frame's columns from the first, middle, and last `n_sample` rows.
+ *
+ * Every row is still checked to be an object and its keys are counted into `n_keys`, which
+ * build_data_frame_sampled() uses to detect keys the sample never saw.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, typename rows_T>
+inline auto diagnose_data_frame_sample(const rows_T& array,
+                                       const R_xlen_t n_sample,
+                                       R_xlen_t&      n_keys)
+    -> std::optional<Column_Schema<type_policy, int64_opt>> {
+
+    const auto n_rows       = r_length(array);
+    const auto middle_start = (n_rows - n_sample) / 2;
+
+    auto cols      = Column_Schema<type_policy, int64_opt>();
+    auto col_index = R_xlen_t(0L);
+    auto i_row     = R_xlen_t(0L);
+
+    for (auto element : array) {
+        simdjson::dom::object object;
+        if (element.get(object) != simdjson::SUCCESS) {
+            return std::nullopt;
+        }
+        n_keys += r_length(object);
+
+        if (i_row < n_sample || i_row >= n_rows - n_sample ||
+            (i_row >= middle_start && i_row < middle_start + n_sample)) {
+            for (auto [key, value] : object) {
+                if (cols.schema.find(key) == std::end(cols.schema)) {
+                    cols.schema[key] = Column<type_policy, int64_opt>{
+                        col_index++, Type_Doctor<type_policy, int64_opt>()};
+                }
+                cols.schema[key].schema.add_element(value);
+            }
+        }
+        i_row++;
+    }
+
+    return cols;
+}
+
+
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, typename rows_T, typename key_T>
+inline auto diagnose_column(const rows_T& array, const key_T key, R_xlen_t& n_found)
+    -> Type_Doctor<type_policy, int64_opt> {
+
+    auto type_doc = Type_Doctor<type_policy, int64_opt>();
+    for (auto object : array) {
+        simdjson::dom::element element;
+        if (lookup(object, key).get(element) == simdjson::SUCCESS) {
+            type_doc.add_element(element);
+            n_found++;
+        }
+    }
+
+    return type_doc;
+}
+
+
+/**
+ * @brief Build a column assuming its sampled diagnosis holds for every row.
+ *
+ * Unsampled values are diagnosed as they are built; returns std::nullopt as soon as one would
+ * change the column's common R type.
+ */
+template <int                 RTYPE,
+          rcpp_T              R_Type,
+          Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          typename rows_T>
+inline auto build_col_speculative(const rows_T&                      array,
+                                  const std::string_view              key,
+                                  Type_Doctor<type_policy, int64_opt> type_doc,
+                                  R_xlen_t&                           n_found)
+    -> std::optional<SEXP> {
+
+    const auto common_R_type = type_doc.common_R_type();
+    auto       out           = [n_rows = std::size(array)]() {
+        if constexpr (R_Type == rcpp_T::i64) {
+            return Rcpp::Vector<RTYPE>(n_rows, utils::int64_bits(NA_INTEGER64));
+        } else {
+            return Rcpp::Vector<RTYPE>(n_rows, na_val<R_Type>());
+        }
+    }();
+    auto i_row = R_xlen_t(0L);
+    auto n_col = R_xlen_t(0L);
+
+    for (auto object : array) {
+        simdjson::dom::element element;
+        if (object.get_object().at_key(key).get(element) == simdjson::SUCCESS) {
+            if (!type_doc.has_seen(element)) {
+                type_doc.add_element(element);
+                if (type_doc.common_R_type() != common_R_type) {
+                    return std::nullopt;
+                }
+            }
+            if constexpr (R_Type == rcpp_T::i64) {
+                out[i_row] = utils::int64_bits(get_declared_scalar<rcpp_T::i64>(element));
+            } else {
+                out[i_row] = get_scalar_dispatch<RTYPE>(element);
+            }
+            n_col++;
+        }
+        i_row++;
+    }
+
+    n_found += n_col;
+    if constexpr (R_Type == rcpp_T::i64) {
+        return utils::as_integer64(out);
+    } else {
+        return compact::compact(out);
+    }
+}
+
+
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename rows_T>
+inline auto build_column_speculative(const rows_T&                             array,
+                                     const std::string_view                     key,
+                                     const Type_Doctor<type_policy, int64_opt>& type_doc,
+                                     R_xlen_t&                                  n_found,
+                                     SEXP                                       empty_array,
+                                     SEXP                                       empty_object,
+                                     SEXP                                       single_null)
+    -> std::optional<SEXP> {
+
+    switch (type_doc.common_R_type()) {
+        case rcpp_T::chr:
+        case rcpp_T::u64:
+            return build_col_speculative<STRSXP, rcpp_T::chr>(array, key, type_doc, n_found);
+
+        case rcpp_T::dbl:
+            return build_col_speculative<REALSXP, rcpp_T::dbl>(array, key, type_doc, n_found);
+
+        case rcpp_T::i64: {
+            if constexpr (int64_opt == utils::Int64_R_Type::Double) {
+                return build_col_speculative<REALSXP, rcpp_T::dbl>(array, key, type_doc, n_found);
+            }
+            if constexpr (int64_opt == utils::Int64_R_Type::String) {
+                return build_col_speculative<STRSXP, rcpp_T::chr>(array, key, type_doc, n_found);
+            }
+            if constexpr (int64_opt == utils::Int64_R_Type::Integer64 ||
+                          int64_opt == utils::Int64_R_Type::Always) {
+                return build_col_speculative<REALSXP, rcpp_T::i64>(array, key, type_doc, n_found);
+            }
+        }
+            [[fallthrough]];
+
+        case rcpp_T::i32:
+            return build_col_speculative<INTSXP, rcpp_T::i32>(array, key, type_doc, n_found);
+
+        case rcpp_T::lgl:
+        case rcpp_T::null:
+            return build_col_speculative<LGLSXP, rcpp_T::lgl>(array, key, type_doc, n_found);
+
+        default: // arrays or objects: every value is simplified on its own, so nothing to check
+            return build_col_list<type_policy, int64_opt, simplify_to>(
+                array, key, n_found, empty_array, empty_object, single_null);
+    }
+}
+
+
+/**
+ * @brief Build a data frame assuming `cols` holds for every row.
+ *
+ * Columns contradicted by a row are rediagnosed from all of their values and rebuilt. If `cols`
+ * misses a key or has a column that no row has, the whole data frame is rediagnosed and rebuilt.
+ *
+ * @param n_keys The total number of keys in all of `array`'s objects.
+ */
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename rows_T>
+inline auto build_data_frame_speculative(const rows_T&                               array,
+                                         const Column_Schema<type_policy, int64_opt>& cols,
+                                         const R_xlen_t                               n_keys,
+                                         SEXP                                         empty_array,
+                                         SEXP                                         empty_object,
+                                         SEXP                                         single_null)
+    -> SEXP {
+
+    auto out          = Rcpp::List(std::size(cols.schema));
+    auto out_names    = Rcpp::CharacterVector(std::size(cols.schema));
+    auto n_found      = R_xlen_t(0L);
+    auto all_col_seen = true;
+
+    for (auto&& [key, col] : cols.schema) {
+        out_names[col.index] = Rcpp::String(std::string(key));
+        const auto n_before  = n_found;
+
+        if (auto speculative = build_column_speculative<type_policy, int64_opt, simplify_to>(
+                array,
+                key,
+                col.schema,
+                n_found,
+                empty_array,
+                empty_object,
+                single_null)) {
+            out[col.index] = *speculative;
+        } else { // contradicted: rediagnose this column from all of its values
+            const auto type_doc = diagnose_column<type_policy, int64_opt>(array, key, n_found);
+            out[col.index]      = build_column<type_policy, int64_opt, simplify_to>(
+                array, key, type_doc, empty_array, empty_object, single_null);
+        }
+        all_col_seen = all_col_seen && n_found != n_before;
+    }
+
+    if (n_found != n_keys || !all_col_seen) { // `cols` doesn't fit: start over
+        const auto full_cols = diagnose_data_frame<type_policy, int64_opt>(array);
+        return build_data_frame<type_policy, int64_opt, simplify_to>(
+            array, full_cols->schema, empty_array, empty_object, single_null);
+    }
+
+    out.attr("names")     = out_names;
+    out.attr("row.names") = Rcpp::seq_len(r_length(array)); /* `Rcpp::seq()` throws if empty */
+    out.attr("class")     = "data.frame";
+
+    return out;
+}
+
+
+/**
+ * @brief Build a data frame from a diagnosis of only the first, middle, and last `schema_sample`
+ * rows.
+ *
+ * Returns std::nullopt if `array` isn't an array of objects.
+ *
+ * @note Column order follows the sample, so keys that first appear outside of it may be ordered
+ * differently than with a full diagnosis.
+ */
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename rows_T>
+inline auto build_data_frame_sampled(const rows_T& array,
+                                     SEXP           empty_array,
+                                     SEXP           empty_object,
+                                     SEXP           single_null,
+                                     const R_xlen_t schema_sample) -> std::optional<SEXP> {
+
+    auto n_keys = R_xlen_t(0L);
+    if (const auto cols =
+            diagnose_data_frame_sample<type_policy, int64_opt>(array, schema_sample, n_keys)) {
+        return build_data_frame_speculative<type_policy, int64_opt, simplify_to>(
+            array, *cols, n_keys, empty_array, empty_object, single_null);
+    }
+
+    return std::nullopt;
+}
+
+
+/**
+ * @brief Build a data frame from a cached schema, such as one returned by `json_schema()`.
+ *
+ * Values that fit a cached column's type keep it. Returns std::nullopt if `array` isn't an array
+ * of objects.
+ *
+ * @param cached_schema Named integer vector of rcpp_T codes, one per column, in column order.
+ */
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename rows_T>
+inline auto build_data_frame_cached(const rows_T&             array,
+                                    const Rcpp::IntegerVector& cached_schema,
+                                    SEXP                       empty_array,
+                                    SEXP                       empty_object,
+                                    SEXP                       single_null)
+    -> std::optional<SEXP> {
+
+    auto n_keys = R_xlen_t(0L);
+    for (auto element : array) {
+        simdjson::dom::object object;
+        if (element.get(object) != simdjson::SUCCESS) {
+            return std::nullopt;
+        }
+        n_keys += r_length(object);
+    }
+
+    const auto names = Rcpp::CharacterVector(cached_schema.attr("names"));
+    auto       cols  = Column_Schema<type_policy, int64_opt>();
+    for (R_xlen_t j = 0; j < r_length(cached_schema); ++j) {
+        cols.schema[std::string_view(CHAR(STRING_ELT(names, j)))] = Column<type_policy, int64_opt>{
+            j, Type_Doctor<type_policy, int64_opt>(static_cast<rcpp_T>(cached_schema[j]))};
+    }
+
+    return build_data_frame_speculative<type_policy, int64_opt, simplify_to>(
+        array, cols, n_keys, empty_array, empty_object, single_null);
+}
+
+
+// selected columns ================================================================================
+/**
+ * @brief Build a data frame of only the columns in `select`.
+ *
+ * Each column is diagnosed and built from its own values alone, so keys that aren't selected are
+ * never visited. Rows without a selected value get NA. Returns std::nullopt if `array` isn't an
+ * array of objects.
+ *
+ * @param select  Named character vector of JSON Pointers, relative to each row, in column order.
+ * Pointers to a top-level key are looked up with `at_key()`.
+ */
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename rows_T>
+inline auto build_data_frame_selected(const rows_T&                array,
+                                      const Rcpp::CharacterVector& select,
+                                      SEXP                         empty_array,
+                                      SEXP                         empty_object,
+                                      SEXP                         single_null)
+    -> std::optional<SEXP> {
+
+    for (auto element : array) {
+        if (element.type() != simdjson::dom::element_type::OBJECT) {
+            return std::nullopt;
+        }
+    }
+
+    const auto n_cols = r_length(select);
+    auto       out    = Rcpp::List(n_cols);
+
+    const auto build = [&](const auto key) {
+        auto       n_found  = R_xlen_t(0L);
+        const auto type_doc = diagnose_column<type_policy, int64_opt>(array, key, n_found);
+        return build_column<type_policy, int64_opt, simplify_to>(
+            array, key, type_doc, empty_array, empty_object, single_null);
+    };
+
+    for (R_xlen_t j = 0; j < n_cols; ++j) {
+        const auto pointer = std::string_view(CHAR(STRING_ELT(select, j)));
+        if (const auto key = pointer.substr(1); key.find_first_of("/~") == std::string_view::npos) {
+            out[j] = build(key);
+        } else {
+            out[j] = build(Column_Pointer{pointer});
+        }
+    }
+
+    out.attr("names")     = select.attr("names");
+    out.attr("row.names") = Rcpp::seq_len(r_length(array));
     out.attr("class")     = "data.frame";
 
     return out;
@@ -0,0 +1,202 @@
+#ifndef RCPPSIMDJSON__DESERIALIZE__FILTER_HPP
+#define RCPPSIMDJSON__DESERIALIZE__FILTER_HPP
+
+
+#include "../common.hpp"
+
+
+namespace rcppsimdjson {
+namespace deserialize {
+
+
+enum class Filter_Op : int {
+    exists = 0,
+    equals = 1,
+    is_in  = 2,
+    gt     = 3,
+    ge     = 4,
+    lt     = 5,
+    le     = 6,
+};
+
+
+/**
+ * @brief A single condition on the value found by a JSON Pointer relative to each row.
+ *
+ * `equals` and `is_in` match strings, numbers, Booleans, and `null` against their literals;
+ * comparisons only match numbers. Arrays and objects never match anything but `exists`.
+ */
+class Predicate {
+    std::string_view              pointer;
+    bool                          is_key = false;
+    Filter_Op                     op     = Filter_Op::exists;
+    std::vector<std::string_view> strings;
+    std::vector<double>           numbers;
+    bool                          has_true  = false;
+    bool                          has_false = false;
+    bool                          has_null  = false;
+
+    [[nodiscard]] inline auto is_literal(simdjson::dom::element value) const -> bool;
+    [[nodiscard]] inline auto compare(double x) const noexcept -> bool;
+
+  public:
+    /**
+     * @param predicate  A list of a JSON Pointer (character), a Filter_Op (integer), and the
+     * literals to compare with (list of scalars or NULLs).
+     */
+    explicit Predicate(SEXP predicate);
+
+    [[nodiscard]] inline auto matches(simdjson::dom::element row) const -> bool;
+};
+
+
+inline Predicate::Predicate(SEXP predicate)
+    : pointer(CHAR(STRING_ELT(VECTOR_ELT(predicate, 0), 0))),
+      op(static_cast<Filter_Op>(Rf_asInteger(VECTOR_ELT(predicate, 1)))) {
+
+    const auto key = pointer.substr(1);
+    is_key         = key.find_first_of("/~") == std::string_view::npos;
+    if (is_key) {
+        pointer = key;
+    }
+
+    const auto literals = VECTOR_ELT(predicate, 2);
+    for (R_xlen_t i = 0; i < Rf_xlength(literals); ++i) {
+        const auto literal = VECTOR_ELT(literals, i);
+        switch (TYPEOF(literal)) {
+            case STRSXP:
+                strings.emplace_back(CHAR(STRING_ELT(literal, 0)));
+                break;
+
+            case INTSXP:
+            case REALSXP:
+                numbers.push_back(Rf_asReal(literal));
+                break;
+
+            case LGLSXP:
+                (LOGICAL(literal)[0] ? has_true : has_false) = true;
+                break;
+
+            default:
+                has_null = true;
+        }
+    }
+}
+
+
+inline auto Predicate::is_literal(simdjson::dom::element value) const -> bool {
+    switch (value.type()) {
+        case simdjson::dom::element_type::STRING: {
+            const auto x = std::string_view(value);
+            return std::find(std::begin(strings), std::end(strings), x) != std::end(strings);
+        }
+
+        case simdjson::dom::element_type::INT64:
+        case simdjson::dom::element_type::UINT64:
+        case simdjson::dom::element_type::DOUBLE: {
+            const auto x = double(value);
+            return std::find(std::begin(numbers), std::end(numbers), x) != std::end(numbers);
+        }
+
+        case simdjson::dom::element_type::BOOL:
+            return bool(value) ? has_true : has_false;
+
+        case simdjson::dom::element_type::NULL_VALUE:
+            return has_null;
+
+        default:
+            return false;
+    }
+}
+
+
+inline auto Predicate::compare(const double x) const noexcept -> bool {
+    const auto y = numbers.front();
+    switch (op) {
+        case Filter_Op::gt:
+            return x > y;
+
+        case Filter_Op::ge:
+            return x >= y;
+
+        case Filter_Op::lt:
+            return x < y;
+
+        case Filter_Op::le:
+            return x <= y;
+
+        default:
+            return false; // # nocov
+    }
+}
+
+
+inline auto Predicate::matches(simdjson::dom::element row) const -> bool {
+    simdjson::dom::element value;
+    const auto error = is_key ? row.get_object().at_key(pointer).get(value)
+                              : row.at_pointer(pointer).get(value);
+    if (error != simdjson::SUCCESS) {
+        return false;
+    }
+
+    switch (op) {
+        case Filter_Op::exists:
+            return true;
+
+        case Filter_Op::equals:
+        case Filter_Op::is_in:
+            return is_literal(value);
+
+        default:
+            switch (value.type()) {
+                case simdjson::dom::element_type::INT64:
+                case simdjson::dom::element_type::UINT64:
+                case simdjson::dom::element_type::DOUBLE:
+                    return compare(double(value));
+
+                default:
+                    return false;
+            }
+    }
+}
+
+
+/**
+ * @brief Keep the elements of `array` that satisfy every predicate in `filter`.
+ *
+ * Elements that aren't objects never do, not even with `exists` predicates, so they are always
+ * dropped (as fparse() documents) and the result is always an array of records.
+ *
+ * @param array  A simdjson::dom::array or a std::vector of simdjson::dom::element.
+ *
+ * @param filter  A list of predicates, as described in Predicate::Predicate().
+ */
+template <typename rows_T>
+inline auto filter_rows(const rows_T& array, SEXP filter) -> std::vector<simdjson::dom::element> {
+
+    auto predicates = std::vector<Predicate>();
+    predicates.reserve(Rf_xlength(filter));
+    for (R_xlen_t i = 0; i < Rf_xlength(filter); ++i) {
+        predicates.emplace_back(VECTOR_ELT(filter, i));
+    }
+
+    auto out = std::vector<simdjson::dom::element>();
+    for (auto element : array) {
+        const auto matches = [element](const Predicate& predicate) {
+            return predicate.matches(element);
+        };
+        if (element.type() == simdjson::dom::element_type::OBJECT &&
+            std::all_of(std::begin(predicates), std::end(predicates), matches)) {
+            out.push_back(element);
+        }
+    }
+
+    return out;
+}
+
+
+} // namespace deserialize
+} // namespace rcppsimdjson
+
+
+#endif
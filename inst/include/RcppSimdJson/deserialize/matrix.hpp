@@ -16,9 +16,9 @@ struct Matrix_Diagnosis {
 };
 
 
-template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, typename array_T>
 inline std::optional<Matrix_Diagnosis>
-diagnose(simdjson::dom::array array) noexcept(RCPPSIMDJSON_NO_EXCEPTIONS) {
+diagnose(const array_T& array) noexcept(RCPPSIMDJSON_NO_EXCEPTIONS) {
     std::unordered_set<std::size_t>     n_cols;
     Type_Doctor<type_policy, int64_opt> matrix_doctor;
 
@@ -44,9 +44,9 @@ diagnose(simdjson::dom::array array) noexcept(RCPPSIMDJSON_NO_EXCEPTIONS) {
 }
 
 
-template <int RTYPE, typename in_T, rcpp_T R_Type, bool has_nulls>
-inline Rcpp::Vector<RTYPE> build_matrix_typed(simdjson::dom::array array,
-                                              const std::size_t    n_cols) {
+template <int RTYPE, typename in_T, rcpp_T R_Type, bool has_nulls, typename array_T>
+inline Rcpp::Vector<RTYPE> build_matrix_typed(const array_T&    array,
+                                              const std::size_t n_cols) {
     const R_xlen_t      n_rows = std::size(array);
     Rcpp::Matrix<RTYPE> out(n_rows, static_cast<R_xlen_t>(n_cols));
     R_xlen_t            j(0L);
@@ -78,19 +78,19 @@ inline Rcpp::Vector<RTYPE> build_matrix_typed(simdjson::dom::array array,
     return out;
 }
 
-template <bool has_nulls>
-inline Rcpp::NumericVector build_matrix_integer64_typed(simdjson::dom::array array,
-                                                        const std::size_t    n_cols) {
-    const auto           n_rows(std::size(array));
-    std::vector<int64_t> stl_vec_int64(n_rows * n_cols);
-    std::size_t          j(0ULL);
+template <bool has_nulls, typename array_T>
+inline Rcpp::NumericVector build_matrix_integer64_typed(const array_T&    array,
+                                                        const std::size_t n_cols) {
+    const R_xlen_t      n_rows(std::size(array));
+    Rcpp::NumericMatrix out(n_rows, static_cast<R_xlen_t>(n_cols));
+    R_xlen_t            j(0L);
 
 #ifdef RCPPSIMDJSON_IS_GCC_7
 
     for (simdjson::dom::array sub_array : array) {
-        std::size_t i(0ULL);
+        R_xlen_t i(0L);
         for (auto&& element : sub_array) {
-            stl_vec_int64[i + j] = get_scalar<int64_t, rcpp_T::i64, has_nulls>(element);
+            out[i + j] = utils::int64_bits(get_scalar<int64_t, rcpp_T::i64, has_nulls>(element));
             i += n_rows;
         }
         j++;
@@ -99,9 +99,9 @@ inline Rcpp::NumericVector build_matrix_integer64_typed(simdjson::dom::array arr
 #else
 
     for (simdjson::dom::array sub_array : array) {
-        std::size_t i(0ULL);
+        R_xlen_t i(0L);
         for (auto element : sub_array) {
-            stl_vec_int64[i + j] = get_scalar<int64_t, rcpp_T::i64, has_nulls>(element);
+            out[i + j] = utils::int64_bits(get_scalar<int64_t, rcpp_T::i64, has_nulls>(element));
             i += n_rows;
         }
         j++;
@@ -109,15 +109,12 @@ inline Rcpp::NumericVector build_matrix_integer64_typed(simdjson::dom::array arr
 
 #endif
 
-    Rcpp::NumericVector out(utils::as_integer64(stl_vec_int64));
-    out.attr("dim") = Rcpp::IntegerVector::create(n_rows, n_cols);
-
-    return out;
+    return utils::as_integer64(out);
 }
 
 
-template <utils::Int64_R_Type int64_opt>
-inline SEXP dispatch_typed(simdjson::dom::array        array,
+template <utils::Int64_R_Type int64_opt, typename array_T>
+inline SEXP dispatch_typed(const array_T&              array,
                            simdjson::dom::element_type element_type,
                            const rcpp_T                R_Type,
                            const bool                  has_nulls,
@@ -188,8 +185,8 @@ inline SEXP dispatch_typed(simdjson::dom::array        array,
     }
 }
 
-template <int RTYPE>
-inline SEXP build_matrix_mixed(simdjson::dom::array array, std::size_t n_cols) {
+template <int RTYPE, typename array_T>
+inline SEXP build_matrix_mixed(const array_T& array, std::size_t n_cols) {
     const R_xlen_t      n_rows(std::size(array));
     Rcpp::Matrix<RTYPE> out(n_rows, static_cast<R_xlen_t>(n_cols));
     R_xlen_t            j(0L);
@@ -220,28 +217,31 @@ inline SEXP build_matrix_mixed(simdjson::dom::array array, std::size_t n_cols) {
 }
 
 
-inline Rcpp::NumericVector build_matrix_integer64_mixed(simdjson::dom::array array,
-                                                        std::size_t          n_cols) {
-    const auto           n_rows(std::size(array));
-    std::vector<int64_t> stl_vec_int64(n_rows * n_cols);
-    std::size_t          j(0ULL);
+template <typename array_T>
+inline Rcpp::NumericVector build_matrix_integer64_mixed(const array_T& array,
+                                                        std::size_t    n_cols) {
+    const R_xlen_t      n_rows(std::size(array));
+    Rcpp::NumericMatrix out(n_rows, static_cast<R_xlen_t>(n_cols));
+    R_xlen_t            j(0L);
 
 #ifdef RCPPSIMDJSON_IS_GCC_7
 
     for (simdjson::dom::array sub_array : array) {
-        std::size_t i(0ULL);
+        R_xlen_t i(0L);
         for (auto&& element : sub_array) {
             switch (element.type()) {
                 case simdjson::dom::element_type::INT64:
-                    stl_vec_int64[i + j] = get_scalar<int64_t, rcpp_T::i64, NO_NULLS>(element);
+                    out[i + j] =
+                        utils::int64_bits(get_scalar<int64_t, rcpp_T::i64, NO_NULLS>(element));
                     break;
 
                 case simdjson::dom::element_type::BOOL:
-                    stl_vec_int64[i + j] = get_scalar<bool, rcpp_T::i64, NO_NULLS>(element);
+                    out[i + j] =
+                        utils::int64_bits(get_scalar<bool, rcpp_T::i64, NO_NULLS>(element));
                     break;
 
                 default:
-                    stl_vec_int64[i + j] = NA_INTEGER64;
+                    out[i + j] = utils::int64_bits(NA_INTEGER64);
             }
             i += n_rows;
         }
@@ -251,19 +251,21 @@ inline Rcpp::NumericVector build_matrix_integer64_mixed(simdjson::dom::array arr
 #else
 
     for (simdjson::dom::array element : array) {
-        std::size_t i(0ULL);
+        R_xlen_t i(0L);
         for (auto sub_element : element) {
             switch (sub_element.type()) {
                 case simdjson::dom::element_type::INT64:
-                    stl_vec_int64[i + j] = get_scalar<int64_t, rcpp_T::i64, NO_NULLS>(sub_element);
+                    out[i + j] =
+                        utils::int64_bits(get_scalar<int64_t, rcpp_T::i64, NO_NULLS>(sub_element));
                     break;
 
                 case simdjson::dom::element_type::BOOL:
-                    stl_vec_int64[i + j] = get_scalar<bool, rcpp_T::i64, NO_NULLS>(sub_element);
+                    out[i + j] =
+                        utils::int64_bits(get_scalar<bool, rcpp_T::i64, NO_NULLS>(sub_element));
                     break;
 
                 default:
-                    stl_vec_int64[i + j] = NA_INTEGER64;
+                    out[i + j] = utils::int64_bits(NA_INTEGER64);
             }
             i += n_rows;
         }
@@ -272,16 +274,13 @@ inline Rcpp::NumericVector build_matrix_integer64_mixed(simdjson::dom::array arr
 
 #endif
 
-    Rcpp::NumericVector out(utils::as_integer64(stl_vec_int64));
-    out.attr("dim") = Rcpp::IntegerVector::create(n_rows, n_cols);
-
-    return out;
+    return utils::as_integer64(out);
 }
 
 
-template <utils::Int64_R_Type int64_opt>
+template <utils::Int64_R_Type int64_opt, typename array_T>
 inline SEXP
-dispatch_mixed(simdjson::dom::array array, const rcpp_T R_Type, const std::size_t n_cols) {
+dispatch_mixed(const array_T& array, const rcpp_T R_Type, const std::size_t n_cols) {
     switch (R_Type) {
         case rcpp_T::chr:
             return build_matrix_mixed<STRSXP>(array, n_cols);
@@ -14,9 +14,15 @@ namespace rcppsimdjson {
 namespace deserialize {
 
 
-template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, Simplify_To simplify_to>
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename array_T>
 inline SEXP
-simplify_list(simdjson::dom::array array, SEXP empty_array, SEXP empty_object, SEXP single_null) {
+simplify_list(const array_T& array,
+              SEXP           empty_array,
+              SEXP           empty_object,
+              SEXP           single_null) {
     Rcpp::List out(r_length(array));
     auto i = R_xlen_t(0);
     for (auto element : array) {
@@ -27,9 +33,15 @@ simplify_list(simdjson::dom::array array, SEXP empty_array, SEXP empty_object, S
 }
 
 
-template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, Simplify_To simplify_to>
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename array_T>
 inline SEXP
-simplify_vector(simdjson::dom::array array, SEXP empty_array, SEXP empty_object, SEXP single_null) {
+simplify_vector(const array_T& array,
+                SEXP           empty_array,
+                SEXP           empty_object,
+                SEXP           single_null) {
     if (const auto type_doctor = Type_Doctor<type_policy, int64_opt>(array);
         type_doctor.is_vectorizable()) {
         return type_doctor.is_homogeneous()
@@ -42,9 +54,15 @@ simplify_vector(simdjson::dom::array array, SEXP empty_array, SEXP empty_object,
 }
 
 
-template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, Simplify_To simplify_to>
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename array_T>
 inline SEXP
-simplify_matrix(simdjson::dom::array array, SEXP empty_array, SEXP empty_object, SEXP single_null) {
+simplify_matrix(const array_T& array,
+                SEXP           empty_array,
+                SEXP           empty_object,
+                SEXP           single_null) {
     if (const auto matrix = matrix::diagnose<type_policy, int64_opt>(array)) {
         return matrix->is_homogeneous
                    ? matrix::dispatch_typed<int64_opt>(array,
@@ -60,11 +78,14 @@ simplify_matrix(simdjson::dom::array array, SEXP empty_array, SEXP empty_object,
 }
 
 
-template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, Simplify_To simplify_to>
-inline SEXP simplify_data_frame(simdjson::dom::array array,
-                                SEXP                 empty_array,
-                                SEXP                 empty_object,
-                                SEXP                 single_null) {
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename array_T>
+inline SEXP simplify_data_frame(const array_T& array,
+                                SEXP           empty_array,
+                                SEXP           empty_object,
+                                SEXP           single_null) {
     if (const auto cols = diagnose_data_frame<type_policy, int64_opt>(array)) {
         return build_data_frame<type_policy, int64_opt, simplify_to>(
             array, cols->schema, empty_array, empty_object, single_null);
@@ -74,11 +95,14 @@ inline SEXP simplify_data_frame(simdjson::dom::array array,
 }
 
 
-template <Type_Policy type_policy, utils::Int64_R_Type int64_opt, Simplify_To simplify_to>
-inline SEXP dispatch_simplify_array(simdjson::dom::array array,
-                                    SEXP                 empty_array,
-                                    SEXP                 empty_object,
-                                    SEXP                 single_null) {
+template <Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt,
+          Simplify_To         simplify_to,
+          typename array_T>
+inline SEXP dispatch_simplify_array(const array_T& array,
+                                    SEXP           empty_array,
+                                    SEXP           empty_object,
+                                    SEXP           single_null) {
     if (std::size(array) == 0) {
         return empty_array;
     }
@@ -148,6 +172,8 @@ inline SEXP simplify_object(const simdjson::dom::object object,
  *
  * @param empty_object R object to return when encountering an empty JSON object.
  *
+ * @param single_null R object to return when encountering a single JSON null.
+ *
  *
  * @return The simplified R object ( @c SEXP ).
  *
@@ -184,7 +210,7 @@ inline SEXP simplify_element(simdjson::dom::element element,
             return single_null;
 
         case simdjson::dom::element_type::UINT64:
-            return Rcpp::wrap(std::to_string(uint64_t(element)));
+            return Rcpp::wrap(utils::number_to_string(uint64_t(element)));
     }
 
     return R_NilValue; // # nocov
@@ -2,36 +2,37 @@
 #define RCPPSIMDJSON__DESERIALIZE__VECTOR_HPP
 
 #include "scalar.hpp"
+#include "../compact.hpp"
 
 namespace rcppsimdjson {
 namespace deserialize {
 namespace vector {
 
 
-template <int RTYPE, typename in_T, rcpp_T R_Type, bool has_nulls>
-inline Rcpp::Vector<RTYPE> build_vector_typed(simdjson::dom::array array) {
+template <int RTYPE, typename in_T, rcpp_T R_Type, bool has_nulls, typename array_T>
+inline SEXP build_vector_typed(const array_T& array) {
     Rcpp::Vector<RTYPE> out(std::size(array));
     R_xlen_t            i(0L);
     for (auto element : array) {
         out[i++] = get_scalar<in_T, R_Type, has_nulls>(element);
     }
-    return out;
+    return compact::compact(out);
 }
 
 
-template <bool has_nulls>
-inline Rcpp::Vector<REALSXP> build_vector_integer64_typed(simdjson::dom::array array) {
-    std::vector<int64_t> stl_vec_int64(std::size(array));
-    std::size_t          i(0ULL);
+template <bool has_nulls, typename array_T>
+inline Rcpp::Vector<REALSXP> build_vector_integer64_typed(const array_T& array) {
+    Rcpp::NumericVector out(std::size(array));
+    R_xlen_t            i(0L);
     for (auto element : array) {
-        stl_vec_int64[i++] = get_scalar<int64_t, rcpp_T::i64, has_nulls>(element);
+        out[i++] = utils::int64_bits(get_scalar<int64_t, rcpp_T::i64, has_nulls>(element));
     }
-    return utils::as_integer64(stl_vec_int64);
+    return utils::as_integer64(out);
 }
 
 
-template <utils::Int64_R_Type int64_opt>
-inline SEXP dispatch_typed(simdjson::dom::array array, const rcpp_T R_Type, const bool has_nulls) {
+template <utils::Int64_R_Type int64_opt, typename array_T>
+inline SEXP dispatch_typed(const array_T& array, const rcpp_T R_Type, const bool has_nulls) {
     switch (R_Type) {
         case rcpp_T::chr:
             return has_nulls
@@ -80,43 +81,44 @@ inline SEXP dispatch_typed(simdjson::dom::array array, const rcpp_T R_Type, cons
 }
 
 
-template <int RTYPE>
-inline Rcpp::Vector<RTYPE> build_vector_mixed(simdjson::dom::array array) {
+template <int RTYPE, typename array_T>
+inline SEXP build_vector_mixed(const array_T& array) {
     Rcpp::Vector<RTYPE> out(std::size(array));
     R_xlen_t            i(0L);
     for (auto element : array) {
         out[i++] = get_scalar_dispatch<RTYPE>(element);
     }
-    return out;
+    return compact::compact(out);
 }
 
 
-inline Rcpp::Vector<REALSXP> build_vector_integer64_mixed(simdjson::dom::array array) {
-    std::vector<int64_t> stl_vec_int64(std::size(array));
-    std::size_t          i(0ULL);
+template <typename array_T>
+inline Rcpp::Vector<REALSXP> build_vector_integer64_mixed(const array_T& array) {
+    Rcpp::NumericVector out(std::size(array));
+    R_xlen_t            i(0L);
 
     for (auto element : array) {
         switch (element.type()) {
             case simdjson::dom::element_type::INT64:
-                stl_vec_int64[i++] = get_scalar<int64_t, rcpp_T::i64, HAS_NULLS>(element);
+                out[i++] = utils::int64_bits(get_scalar<int64_t, rcpp_T::i64, HAS_NULLS>(element));
                 break;
 
             case simdjson::dom::element_type::BOOL:
-                stl_vec_int64[i++] = get_scalar<bool, rcpp_T::i64, HAS_NULLS>(element);
+                out[i++] = utils::int64_bits(get_scalar<bool, rcpp_T::i64, HAS_NULLS>(element));
                 break;
 
             default:
-                stl_vec_int64[i++] = NA_INTEGER64;
+                out[i++] = utils::int64_bits(NA_INTEGER64);
                 break;
         }
     }
 
-    return utils::as_integer64(stl_vec_int64);
+    return utils::as_integer64(out);
 }
 
 
-template <utils::Int64_R_Type int64_opt>
-inline SEXP dispatch_mixed(simdjson::dom::array array, const rcpp_T common_R_type) {
+template <utils::Int64_R_Type int64_opt, typename array_T>
+inline SEXP dispatch_mixed(const array_T& array, const rcpp_T common_R_type) {
     switch (common_R_type) {
         case rcpp_T::chr:
             return build_vector_mixed<STRSXP>(array);
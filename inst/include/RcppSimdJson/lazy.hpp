@@ -0,0 +1,511 @@
+#ifndef RCPPSIMDJSON_LAZY_HPP
+#define RCPPSIMDJSON_LAZY_HPP
+
+
+#include "deserialize.hpp"
+
+#include <algorithm>  /* std::all_of, std::copy_n, std::count */
+#include <cstring>    /* std::strncpy */
+#include <functional> /* std::function */
+#include <memory>     /* std::shared_ptr */
+#include <vector>     /* std::vector */
+
+#include <Rversion.h>
+
+/* ALTREP lists (ALTLIST) were added in R 4.3.0; before that, `lazy` lists are simply eager */
+#if R_VERSION >= R_Version(4, 3, 0)
+#    include <R_ext/Altrep.h>
+#    define RCPPSIMDJSON_HAS_ALTLIST
+#endif
+
+
+namespace rcppsimdjson {
+namespace deserialize {
+namespace lazy {
+
+
+/**
+ * @brief What a lazy list needs to deserialize its elements: their place in the (kept alive)
+ * document, and how to deserialize them.
+ */
+struct Node {
+    std::vector<simdjson::dom::element> children;
+    std::vector<bool>                   is_deserialized;
+    Parse_Opts                          child_opts; /* owns `children`' document */
+};
+
+
+using Rows = std::vector<simdjson::dom::element>;
+
+/**
+ * @brief What a lazy data frame column needs to build its values: the rows shared by all columns,
+ * and how to build the column (or any of its elements) from them.
+ */
+struct Column_Node {
+    std::shared_ptr<const Rows>              rows;
+    std::function<SEXP(const Rows&)>         build; /* e.g. build_column() for the column's key */
+    std::vector<bool>                        is_built;
+    bool                                     is_complete;
+    std::shared_ptr<simdjson::dom::document> document; /* owns `rows` */
+};
+
+
+#ifdef RCPPSIMDJSON_HAS_ALTLIST
+
+/**
+ * @brief The package's ALTLIST class, registered by `R_init_RcppSimdJson()`.
+ */
+inline auto list_class() -> R_altrep_class_t& {
+    static auto altlist_class = R_altrep_class_t{nullptr};
+    return altlist_class;
+}
+
+
+inline auto is_registered() -> bool { return list_class().ptr != nullptr; }
+
+
+/**
+ * @brief Call `fun()`, turning any C++ exception into an R error.
+ *
+ * ALTREP methods are called by R itself, so exceptions must not escape them. The message is copied
+ * to the stack first, so that nothing needing destruction is left when `Rf_error()` jumps.
+ */
+template <typename fun_T>
+inline auto or_r_error(fun_T&& fun) -> decltype(fun()) {
+    char message[8192] = {};
+    try {
+        return fun();
+    } catch (const std::exception& e) {
+        std::strncpy(message, e.what(), sizeof(message) - 1);
+    }
+    Rf_error("%s", message);
+}
+
+
+struct Lazy_List {
+    static auto node(SEXP x) -> Node& {
+        return *static_cast<Node*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+    }
+
+    static R_xlen_t Length(SEXP x) { return std::size(node(x).children); }
+
+    static SEXP Elt(SEXP x, R_xlen_t i) {
+        auto& lazy     = node(x);
+        SEXP  elements = R_altrep_data2(x);
+        if (!lazy.is_deserialized[i]) {
+            SET_VECTOR_ELT(elements, i, or_r_error([&lazy, i]() {
+                               return deserialize(lazy.children[i], lazy.child_opts);
+                           }));
+            lazy.is_deserialized[i] = true;
+        }
+        return VECTOR_ELT(elements, i);
+    }
+
+    static void Set_elt(SEXP x, R_xlen_t i, SEXP value) {
+        SET_VECTOR_ELT(R_altrep_data2(x), i, value);
+        node(x).is_deserialized[i] = true;
+    }
+
+    static void* Dataptr(SEXP x, Rboolean /* writeable */) {
+        for (R_xlen_t i = 0; i < Length(x); ++i) {
+            Elt(x, i);
+        }
+        return DATAPTR(R_altrep_data2(x));
+    }
+
+    static const void* Dataptr_or_null(SEXP x) {
+        const auto& is_deserialized = node(x).is_deserialized;
+        return std::all_of(std::begin(is_deserialized),
+                           std::end(is_deserialized),
+                           [](const bool is) { return is; })
+                   ? DATAPTR(R_altrep_data2(x))
+                   : nullptr;
+    }
+
+    static Rboolean
+    Inspect(SEXP x, int /* pre */, int /* deep */, int /* pvec */, void (*)(SEXP, int, int, int)) {
+        const auto& is_deserialized = node(x).is_deserialized;
+        Rprintf("lazy JSON list (%td of %td elements deserialized)\n",
+                std::count(std::begin(is_deserialized), std::end(is_deserialized), true),
+                Length(x));
+        return TRUE;
+    }
+};
+
+
+/**
+ * @brief The package's ALTREP class for lazy data frame columns of `RTYPE`.
+ */
+template <int RTYPE>
+inline auto column_class() -> R_altrep_class_t& {
+    static auto altrep_class = R_altrep_class_t{nullptr};
+    return altrep_class;
+}
+
+
+/**
+ * @brief A data frame column that is built in one pass the first time its data is needed.
+ *
+ * Until then, single elements (as `str()`, `head()`, or `x[[i]]` take) are built from their own
+ * row only, and kept in a vector of the column's type that is filled as they are.
+ */
+template <int RTYPE>
+struct Lazy_Column {
+    static auto node(SEXP x) -> Column_Node& {
+        return *static_cast<Column_Node*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+    }
+
+    static R_xlen_t Length(SEXP x) { return std::size(*node(x).rows); }
+
+    static SEXP column(SEXP x) {
+        if (auto& lazy = node(x); !lazy.is_complete) {
+            R_set_altrep_data2(x, or_r_error([&lazy]() { return lazy.build(*lazy.rows); }));
+            lazy.is_complete = true;
+            lazy.is_built    = std::vector<bool>();
+        }
+        return R_altrep_data2(x);
+    }
+
+    static SEXP with_element(SEXP x, R_xlen_t i) {
+        auto& lazy = node(x);
+        if (lazy.is_complete || (!std::empty(lazy.is_built) && lazy.is_built[i])) {
+            return R_altrep_data2(x);
+        }
+        if (std::empty(lazy.is_built)) {
+            R_set_altrep_data2(x, Rf_allocVector(RTYPE, Length(x)));
+            lazy.is_built = std::vector<bool>(Length(x));
+        }
+
+        const SEXP values = R_altrep_data2(x);
+        const auto value  = Rcpp::RObject(
+            or_r_error([&lazy, i]() { return lazy.build(Rows{(*lazy.rows)[i]}); }));
+        if constexpr (RTYPE == REALSXP) {
+            REAL(values)[i] = REAL_ELT(value, 0);
+        } else if constexpr (RTYPE == INTSXP) {
+            INTEGER(values)[i] = INTEGER_ELT(value, 0);
+        } else if constexpr (RTYPE == LGLSXP) {
+            LOGICAL(values)[i] = LOGICAL_ELT(value, 0);
+        } else if constexpr (RTYPE == STRSXP) {
+            SET_STRING_ELT(values, i, STRING_ELT(value, 0));
+        } else {
+            SET_VECTOR_ELT(values, i, VECTOR_ELT(value, 0));
+        }
+        lazy.is_built[i] = true;
+
+        return values;
+    }
+
+    static auto Elt(SEXP x, R_xlen_t i) {
+        const SEXP values = with_element(x, i);
+        if constexpr (RTYPE == REALSXP) {
+            return REAL_ELT(values, i);
+        } else if constexpr (RTYPE == INTSXP) {
+            return INTEGER_ELT(values, i);
+        } else if constexpr (RTYPE == LGLSXP) {
+            return LOGICAL_ELT(values, i);
+        } else if constexpr (RTYPE == STRSXP) {
+            return STRING_ELT(values, i);
+        } else {
+            return VECTOR_ELT(values, i);
+        }
+    }
+
+    static void Set_elt(SEXP x, R_xlen_t i, SEXP value) {
+        if constexpr (RTYPE == STRSXP) {
+            SET_STRING_ELT(column(x), i, value);
+        } else {
+            SET_VECTOR_ELT(column(x), i, value);
+        }
+    }
+
+    template <typename value_T>
+    static R_xlen_t Get_region(SEXP x, R_xlen_t i, R_xlen_t n, value_T* out) {
+        const auto n_copied = std::min(n, Length(x) - i);
+        std::copy_n(static_cast<const value_T*>(DATAPTR(column(x))) + i, n_copied, out);
+        return n_copied;
+    }
+
+    static void* Dataptr(SEXP x, Rboolean /* writeable */) { return DATAPTR(column(x)); }
+
+    static const void* Dataptr_or_null(SEXP x) {
+        /* a complete column may be compact (see compact::compact()), and stays so */
+        return node(x).is_complete ? DATAPTR_OR_NULL(R_altrep_data2(x)) : nullptr;
+    }
+
+    static Rboolean
+    Inspect(SEXP x, int /* pre */, int /* deep */, int /* pvec */, void (*)(SEXP, int, int, int)) {
+        const auto& is_built = node(x).is_built;
+        Rprintf("lazy JSON column (%td of %td elements built)\n",
+                node(x).is_complete ? Length(x)
+                                    : std::count(std::begin(is_built), std::end(is_built), true),
+                Length(x));
+        return TRUE;
+    }
+};
+
+
+template <int RTYPE>
+inline void register_column_class(R_altrep_class_t altrep_class) {
+    using Methods = Lazy_Column<RTYPE>;
+
+    column_class<RTYPE>() = altrep_class;
+    R_set_altrep_Length_method(altrep_class, Methods::Length);
+    R_set_altrep_Inspect_method(altrep_class, Methods::Inspect);
+    R_set_altvec_Dataptr_method(altrep_class, Methods::Dataptr);
+    R_set_altvec_Dataptr_or_null_method(altrep_class, Methods::Dataptr_or_null);
+
+    if constexpr (RTYPE == REALSXP) {
+        R_set_altreal_Elt_method(altrep_class, Methods::Elt);
+        R_set_altreal_Get_region_method(altrep_class, Methods::template Get_region<double>);
+    } else if constexpr (RTYPE == INTSXP) {
+        R_set_altinteger_Elt_method(altrep_class, Methods::Elt);
+        R_set_altinteger_Get_region_method(altrep_class, Methods::template Get_region<int>);
+    } else if constexpr (RTYPE == LGLSXP) {
+        R_set_altlogical_Elt_method(altrep_class, Methods::Elt);
+        R_set_altlogical_Get_region_method(altrep_class, Methods::template Get_region<int>);
+    } else if constexpr (RTYPE == STRSXP) {
+        R_set_altstring_Elt_method(altrep_class, Methods::Elt);
+        R_set_altstring_Set_elt_method(altrep_class, Methods::Set_elt);
+    } else {
+        R_set_altlist_Elt_method(altrep_class, Methods::Elt);
+        R_set_altlist_Set_elt_method(altrep_class, Methods::Set_elt);
+    }
+}
+
+
+inline void register_classes(DllInfo* dll) {
+    auto& altlist_class = list_class();
+    altlist_class       = R_make_altlist_class("lazy_json_list", "RcppSimdJson", dll);
+
+    R_set_altrep_Length_method(altlist_class, Lazy_List::Length);
+    R_set_altrep_Inspect_method(altlist_class, Lazy_List::Inspect);
+    R_set_altvec_Dataptr_method(altlist_class, Lazy_List::Dataptr);
+    R_set_altvec_Dataptr_or_null_method(altlist_class, Lazy_List::Dataptr_or_null);
+    R_set_altlist_Elt_method(altlist_class, Lazy_List::Elt);
+    R_set_altlist_Set_elt_method(altlist_class, Lazy_List::Set_elt);
+
+    register_column_class<REALSXP>(
+        R_make_altreal_class("lazy_json_dbl_column", "RcppSimdJson", dll));
+    register_column_class<INTSXP>(
+        R_make_altinteger_class("lazy_json_int_column", "RcppSimdJson", dll));
+    register_column_class<LGLSXP>(
+        R_make_altlogical_class("lazy_json_lgl_column", "RcppSimdJson", dll));
+    register_column_class<STRSXP>(
+        R_make_altstring_class("lazy_json_chr_column", "RcppSimdJson", dll));
+    register_column_class<VECSXP>(
+        R_make_altlist_class("lazy_json_list_column", "RcppSimdJson", dll));
+}
+
+
+/**
+ * @brief A lazy list of `children`, deserialized like the elements of a list built from
+ * `parse_opts` would be.
+ */
+inline auto make_list(std::vector<simdjson::dom::element>&& children, const Parse_Opts& parse_opts)
+    -> SEXP {
+    /* like simplify_list() and simplify_object(), elements are simplified as they are */
+    auto child_opts      = parse_opts;
+    child_opts.schema    = R_NilValue;
+    child_opts.select    = R_NilValue;
+    child_opts.filter    = R_NilValue;
+    child_opts.spill_dir = R_NilValue;
+
+    const auto n = std::size(children);
+    auto       node =
+        Rcpp::XPtr<Node>(new Node{std::move(children), std::vector<bool>(n), child_opts},
+                         true,
+                         R_NilValue,
+                         Rcpp::List::create(child_opts.empty_array,
+                                            child_opts.empty_object,
+                                            child_opts.single_null));
+    auto elements = Rcpp::List(n);
+
+    return R_new_altrep(list_class(), node, elements);
+}
+
+
+/**
+ * @brief The R type of the column build_column() makes of values diagnosed as `R_Type`.
+ */
+template <utils::Int64_R_Type int64_opt>
+inline constexpr auto column_type(const rcpp_T R_Type) noexcept -> int {
+    switch (R_Type) {
+        case rcpp_T::chr:
+        case rcpp_T::u64:
+            return STRSXP;
+
+        case rcpp_T::dbl:
+            return REALSXP;
+
+        case rcpp_T::i64:
+            return int64_opt == utils::Int64_R_Type::String ? STRSXP : REALSXP;
+
+        case rcpp_T::i32:
+            return INTSXP;
+
+        case rcpp_T::lgl:
+        case rcpp_T::null:
+            return LGLSXP;
+
+        default:
+            return VECSXP;
+    }
+}
+
+
+template <int RTYPE>
+inline auto make_column(const std::shared_ptr<const Rows>& rows,
+                        std::function<SEXP(const Rows&)>&& build,
+                        const Parse_Opts&                  parse_opts) -> SEXP {
+    auto node = Rcpp::XPtr<Column_Node>(
+        new Column_Node{rows, std::move(build), std::vector<bool>(), false, parse_opts.document},
+        true,
+        R_NilValue,
+        Rcpp::List::create(
+            parse_opts.empty_array, parse_opts.empty_object, parse_opts.single_null));
+
+    return R_new_altrep(column_class<RTYPE>(), node, R_NilValue);
+}
+
+
+/**
+ * @brief A data frame like build_data_frame()'s, but whose columns are only built once used.
+ *
+ * `cols` must already be diagnosed, so that each column's type (and the data frame's shape) is
+ * known up front.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline auto make_data_frame(const simdjson::dom::array                  array,
+                            const Column_Schema<type_policy, int64_opt>& cols,
+                            const Parse_Opts&                            parse_opts) -> SEXP {
+    const auto rows      = std::make_shared<const Rows>(std::begin(array), std::end(array));
+    const auto n_rows    = R_xlen_t(std::size(*rows));
+    auto       out       = Rcpp::List(std::size(cols.schema));
+    auto       out_names = Rcpp::CharacterVector(std::size(cols.schema));
+
+    for (auto&& [key, col] : cols.schema) {
+        auto build = [key = key, type_doc = col.schema, parse_opts](const Rows& rows) -> SEXP {
+            return build_column<type_policy, int64_opt, Simplify_To::data_frame>(
+                rows,
+                key,
+                type_doc,
+                parse_opts.empty_array,
+                parse_opts.empty_object,
+                parse_opts.single_null);
+        };
+
+        out_names[col.index] = Rcpp::String(std::string(key));
+        switch (column_type<int64_opt>(col.schema.common_R_type())) {
+            case REALSXP:
+                out[col.index] = make_column<REALSXP>(rows, std::move(build), parse_opts);
+                break;
+
+            case INTSXP:
+                out[col.index] = make_column<INTSXP>(rows, std::move(build), parse_opts);
+                break;
+
+            case LGLSXP:
+                out[col.index] = make_column<LGLSXP>(rows, std::move(build), parse_opts);
+                break;
+
+            case STRSXP:
+                out[col.index] = make_column<STRSXP>(rows, std::move(build), parse_opts);
+                break;
+
+            default:
+                out[col.index] = make_column<VECSXP>(rows, std::move(build), parse_opts);
+        }
+
+        if constexpr (int64_opt == utils::Int64_R_Type::Integer64 ||
+                      int64_opt == utils::Int64_R_Type::Always) {
+            if (col.schema.common_R_type() == rcpp_T::i64) {
+                Rf_setAttrib(out[col.index], R_ClassSymbol, Rf_mkString("integer64"));
+            }
+        }
+    }
+
+    out.attr("names")     = out_names;
+    out.attr("row.names") = Rcpp::seq_len(n_rows); /* `Rcpp::seq()` throws if `n_rows == 0` */
+    out.attr("class")     = "data.frame";
+
+    return out;
+}
+
+#else
+
+inline void register_classes(DllInfo*) {}
+
+#endif
+
+
+} // namespace lazy
+
+
+/**
+ * @brief Deserialize a non-empty object (or, at `Simplify_To::list`, array) as a lazy list whose
+ * elements are only deserialized when R first accesses them, or an array of objects as a data
+ * frame whose columns are only built when first used.
+ *
+ * The result is identical to the eager one, but deserializing `parsed` itself costs only a pass
+ * over its immediate children (plus, for data frames, diagnosing their columns), and elements or
+ * columns that are never accessed are never built.
+ *
+ * @return The lazy list or data frame, or `std::nullopt` if `parsed` must be deserialized eagerly.
+ */
+inline auto deserialize_lazily([[maybe_unused]] simdjson::dom::element parsed,
+                               [[maybe_unused]] const Parse_Opts&      parse_opts)
+    -> std::optional<SEXP> {
+#ifdef RCPPSIMDJSON_HAS_ALTLIST
+    if (!lazy::is_registered()) {
+        return std::nullopt; /* e.g. when used from another package's headers */
+    }
+
+    if (simdjson::dom::object object;
+        parsed.get(object) == simdjson::SUCCESS && std::size(object) != 0) {
+        auto children = std::vector<simdjson::dom::element>();
+        auto names    = Rcpp::CharacterVector(std::size(object));
+        auto i        = R_xlen_t(0L);
+        for (auto [key, value] : object) {
+            children.push_back(value);
+            names[i++] = Rcpp::String(std::string(key));
+        }
+        auto out = Rcpp::RObject(lazy::make_list(std::move(children), parse_opts));
+        out.attr("names") = names;
+        return out;
+    }
+
+    if (simdjson::dom::array array; parse_opts.simplify_to == Simplify_To::list &&
+                                    parsed.get(array) == simdjson::SUCCESS &&
+                                    std::size(array) != 0) {
+        auto children = std::vector<simdjson::dom::element>(std::begin(array), std::end(array));
+        return lazy::make_list(std::move(children), parse_opts);
+    }
+
+    /* sampled diagnoses build columns speculatively, so only full diagnoses are deferred */
+    if (simdjson::dom::array array; parse_opts.simplify_to == Simplify_To::data_frame &&
+                                    parse_opts.schema_sample == 0 &&
+                                    parsed.get(array) == simdjson::SUCCESS &&
+                                    std::size(array) != 0) {
+        const auto build_lazily = [&array,
+                                   &parse_opts](auto policy,
+                                                auto int64_r_type) -> std::optional<SEXP> {
+            constexpr auto policy_v    = decltype(policy)::value;
+            constexpr auto int64_opt_v = decltype(int64_r_type)::value;
+            if (const auto cols = diagnose_data_frame<policy_v, int64_opt_v>(array)) {
+                return lazy::make_data_frame<policy_v, int64_opt_v>(array, *cols, parse_opts);
+            }
+            return std::nullopt;
+        };
+        return dispatch_parse_opts(parse_opts, build_lazily);
+    }
+#endif
+
+    return std::nullopt;
+}
+
+
+} // namespace deserialize
+} // namespace rcppsimdjson
+
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef RCPPSIMDJSON_NDJSON_HPP
+#define RCPPSIMDJSON_NDJSON_HPP
+
+
+#include "serialize.hpp"
+
+#include <algorithm>   /* std::max, std::min */
+#include <array>       /* std::array */
+#include <cmath>       /* std::isfinite */
+#include <cstring>     /* std::memcpy */
+#include <optional>    /* std::optional */
+#include <string>      /* std::string */
+#include <string_view> /* std::string_view */
+#include <vector>      /* std::vector */
+
+
+namespace rcppsimdjson {
+namespace serialize {
+
+
+/**
+ * @brief One column of a data frame, prepared (on R's thread) so that any thread can write its
+ * fields without touching R's API: build_data_frame()'s columns in reverse.
+ *
+ * Its `"key":` is escaped once, as are a factor's levels. Strings are viewed as UTF-8 up front,
+ * and list and data frame columns, which can hold any R object, are serialized up front, as are
+ * the rows of matrix columns.
+ */
+class Column_Writer {
+    Vector_Kind                             kind;
+    bool                                    is_matrix = false;
+    std::string                             prefix; /* `,"key":` */
+    const int*                              ints    = nullptr;
+    const double*                           doubles = nullptr;
+    std::vector<std::optional<std::string>> strings = std::vector<std::optional<std::string>>();
+    std::vector<std::optional<std::string_view>> utf8 =
+        std::vector<std::optional<std::string_view>>();
+
+    [[nodiscard]] inline auto read_int64(const R_xlen_t i) const noexcept -> int64_t {
+        int64_t value;
+        std::memcpy(&value, &(doubles[i]), sizeof(int64_t));
+        return value;
+    }
+
+  public:
+    Column_Writer(SEXP column, SEXP name, R_xlen_t n_rows, const Serialize_Opts& opts);
+
+    [[nodiscard]] inline auto is_na(R_xlen_t i) const noexcept -> bool;
+
+    /**
+     * @brief Append the field of row `i` to `out`, led by `,` unless it's the row's first.
+     */
+    inline void write(std::string& out, R_xlen_t i, bool is_first) const;
+};
+
+
+inline Column_Writer::Column_Writer(SEXP                  column,
+                                    SEXP                  name,
+                                    const R_xlen_t        n_rows,
+                                    const Serialize_Opts& opts)
+    : kind(classify(column)), prefix(",") {
+
+    write_string(prefix, Rf_translateCharUTF8(name));
+    prefix.push_back(':');
+
+    if (classify_column(column).is_matrix) {
+        /* each field is a row, which is never left out */
+        is_matrix       = true;
+        auto serializer = Serializer(opts);
+        strings.reserve(n_rows);
+        for (R_xlen_t i = 0; i < n_rows; ++i) {
+            serializer.out.clear();
+            serializer.write_matrix_row(column, kind, i);
+            strings.emplace_back(serializer.out);
+        }
+        return;
+    }
+
+    switch (kind) {
+        case Vector_Kind::lgl:
+            ints = LOGICAL(column);
+            break;
+
+        case Vector_Kind::i32:
+            ints = INTEGER(column);
+            break;
+
+        case Vector_Kind::factor: {
+            ints              = INTEGER(column);
+            const auto levels = Rf_getAttrib(column, R_LevelsSymbol);
+            for (R_xlen_t i = 0; i < Rf_xlength(levels); ++i) {
+                auto& level = strings.emplace_back(std::string());
+                write_string(*level, Rf_translateCharUTF8(STRING_ELT(levels, i)));
+            }
+            break;
+        }
+
+        case Vector_Kind::dbl:
+        case Vector_Kind::i64:
+            doubles = REAL(column);
+            break;
+
+        case Vector_Kind::chr:
+            utf8.reserve(n_rows);
+            for (R_xlen_t i = 0; i < n_rows; ++i) {
+                if (const auto x = STRING_ELT(column, i); x == NA_STRING) {
+                    utf8.emplace_back(std::nullopt);
+                } else {
+                    utf8.emplace_back(Rf_translateCharUTF8(x));
+                }
+            }
+            break;
+
+        default: {
+            /* a list, raw, or data frame column: each field is serialized now */
+            auto serializer = Serializer(opts);
+            strings.reserve(n_rows);
+            for (R_xlen_t i = 0; i < n_rows; ++i) {
+                if (is_na_element(column, kind, i)) {
+                    strings.emplace_back(std::nullopt);
+                    continue;
+                }
+                serializer.out.clear();
+                serializer.write_element(column, kind, i);
+                strings.emplace_back(serializer.out);
+            }
+            break;
+        }
+    }
+}
+
+
+inline auto Column_Writer::is_na(const R_xlen_t i) const noexcept -> bool {
+    if (is_matrix) {
+        return false;
+    }
+    switch (kind) {
+        case Vector_Kind::lgl:
+            return ints[i] == NA_LOGICAL;
+        case Vector_Kind::i32:
+        case Vector_Kind::factor:
+            return ints[i] == NA_INTEGER;
+        case Vector_Kind::dbl:
+            return !std::isfinite(doubles[i]);
+        case Vector_Kind::i64:
+            return read_int64(i) == NA_INTEGER64;
+        case Vector_Kind::chr:
+            return !utf8[i];
+        default:
+            return !strings[i];
+    }
+}
+
+
+inline void Column_Writer::write(std::string& out, const R_xlen_t i, const bool is_first) const {
+    out.append(prefix, is_first ? 1 : 0);
+
+    std::array<char, utils::NUMBER_BUFFER_SIZE> number;
+    const auto write_number = [&out, &number](const auto x) {
+        const auto end = utils::format_number(number.data(), number.data() + number.size(), x);
+        out.append(number.data(), end - number.data());
+    };
+
+    if (is_matrix) {
+        out.append(*strings[i]);
+        return;
+    }
+    switch (kind) {
+        case Vector_Kind::lgl:
+            out.append(ints[i] ? "true" : "false");
+            break;
+
+        case Vector_Kind::i32:
+            write_number(ints[i]);
+            break;
+
+        case Vector_Kind::factor:
+            out.append(*strings[ints[i] - 1]);
+            break;
+
+        case Vector_Kind::dbl:
+            write_number(doubles[i]);
+            break;
+
+        case Vector_Kind::i64:
+            write_number(read_int64(i));
+            break;
+
+        case Vector_Kind::chr:
+            write_string(out, *utf8[i]);
+            break;
+
+        default:
+            out.append(*strings[i]);
+            break;
+    }
+}
+
+
+/**
+ * @brief Write each row of the data frame `x` as a line of NDJSON, an object whose `NA` fields
+ * are left out, passing them to `sink(bytes, size)` in order.
+ *
+ * Rows are written a chunk at a time, into a buffer per chunk, by up to `n_threads` OpenMP
+ * threads. Each round of chunks is passed to `sink` (on R's thread) once they're all written, so
+ * only a round of chunks is ever in memory.
+ *
+ * @return The number of rows written.
+ */
+template <typename sink_T>
+inline auto write_ndjson(SEXP x, const Serialize_Opts& opts, const int n_threads, sink_T&& sink)
+    -> R_xlen_t {
+    constexpr auto CHUNK_ROWS = R_xlen_t(2048);
+
+    const auto n_rows  = Rf_xlength(Rf_getAttrib(x, R_RowNamesSymbol));
+    const auto names   = Rf_getAttrib(x, R_NamesSymbol);
+    auto       columns = std::vector<Column_Writer>();
+    for (R_xlen_t j = 0; j < Rf_xlength(x); ++j) {
+        columns.emplace_back(VECTOR_ELT(x, j), STRING_ELT(names, j), n_rows, opts);
+    }
+
+    const auto n_workers = std::max(1, n_threads);
+    auto       buffers   = std::vector<std::string>(4 * n_workers);
+
+    for (auto round_start = R_xlen_t(0); round_start < n_rows;
+         round_start += CHUNK_ROWS * r_length(buffers)) {
+        const auto n_chunks = static_cast<int>(std::min(
+            r_length(buffers), (n_rows - round_start + CHUNK_ROWS - 1) / CHUNK_ROWS));
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(n_workers) schedule(dynamic, 1)
+#endif
+        for (int chunk = 0; chunk < n_chunks; ++chunk) {
+            auto&      out  = buffers[chunk];
+            const auto from = round_start + chunk * CHUNK_ROWS;
+            const auto to   = std::min(n_rows, from + CHUNK_ROWS);
+            out.clear();
+            for (auto i = from; i < to; ++i) {
+                out.push_back('{');
+                auto is_first = true;
+                for (const auto& column : columns) {
+                    if (!column.is_na(i)) {
+                        column.write(out, i, is_first);
+                        is_first = false;
+                    }
+                }
+                out.append("}\n");
+            }
+        }
+
+        for (int chunk = 0; chunk < n_chunks; ++chunk) {
+            sink(buffers[chunk].data(), std::size(buffers[chunk]));
+        }
+    }
+
+    return n_rows;
+}
+
+
+} // namespace serialize
+} // namespace rcppsimdjson
+
+
+#endif
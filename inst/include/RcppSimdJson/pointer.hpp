@@ -0,0 +1,381 @@
+#ifndef RCPPSIMDJSON_POINTER_HPP
+#define RCPPSIMDJSON_POINTER_HPP
+
+
+#include "common.hpp"
+
+#include <functional>    /* std::hash */
+#include <limits>        /* std::numeric_limits */
+#include <unordered_map> /* std::unordered_multimap */
+
+
+namespace rcppsimdjson {
+namespace pointer {
+
+
+/**
+ * @brief A JSON Pointer reference token, already unescaped.
+ *
+ * In an extended pointer (see is_extended()), a token of `*` is a wildcard that matches every
+ * element of an array or every value of an object, and a token of `start:end` is a slice that
+ * matches the elements of an array from `start` up to, but excluding, `end`; either bound may be
+ * omitted. Tokens that are valid array indices also hold that index, and every token holds the
+ * hash of its key.
+ */
+struct Token {
+    std::string                key         = std::string();
+    std::size_t                hash        = 0;
+    std::optional<std::size_t> index       = std::nullopt;
+    bool                       is_wildcard = false;
+    bool                       is_slice    = false;
+    std::size_t                slice_start = 0;
+    std::size_t                slice_end   = std::numeric_limits<std::size_t>::max();
+};
+
+
+/**
+ * @brief The hash tokens keep of their keys, and that object keys are looked up by.
+ */
+inline auto hash_key(const std::string_view key) noexcept -> std::size_t {
+    return std::hash<std::string_view>()(key);
+}
+
+
+/**
+ * @brief Parse an unescaped token as an array index, if it is one.
+ */
+inline auto as_index(const std::string_view raw) -> std::optional<std::size_t> {
+    const auto is_digit = [](const char c) { return c >= '0' && c <= '9'; };
+    if (!raw.empty() && std::size(raw) <= 18 &&
+        std::all_of(std::begin(raw), std::end(raw), is_digit) &&
+        (raw == "0" || raw.front() != '0')) {
+        return std::stoull(std::string(raw));
+    }
+    return std::nullopt;
+}
+
+
+/**
+ * @brief Whether `pointer` opts into wildcards and slices, by starting with `$` instead of `/`.
+ *
+ * Otherwise, `pointer` is plain RFC 6901, where `*` and `start:end` are only ever keys.
+ */
+inline auto is_extended(const std::string_view pointer) noexcept -> bool {
+    return !pointer.empty() && pointer.front() == '$';
+}
+
+
+/**
+ * @brief Split a JSON Pointer, which may be extended (see is_extended()), into its reference
+ * tokens.
+ *
+ * @return std::nullopt if `pointer`, less any leading `$`, is neither empty nor starts with `/`.
+ */
+inline auto tokenize(std::string_view pointer) -> std::optional<std::vector<Token>> {
+    const auto extended = is_extended(pointer);
+    if (extended) {
+        pointer.remove_prefix(1);
+    }
+    if (!pointer.empty() && pointer.front() != '/') {
+        return std::nullopt;
+    }
+
+    auto out = std::vector<Token>();
+    for (auto start = std::size_t(1); start <= std::size(pointer);) {
+        const auto end = std::min(pointer.find('/', start), std::size(pointer));
+        const auto raw = pointer.substr(start, end - start);
+        start          = end + 1;
+
+        auto token = Token();
+        if (extended && raw == "*") {
+            token.is_wildcard = true;
+            out.push_back(std::move(token));
+            continue;
+        }
+
+        for (std::size_t i = 0; i < std::size(raw); ++i) {
+            const auto is_escape =
+                raw[i] == '~' && i + 1 < std::size(raw) && (raw[i + 1] == '0' || raw[i + 1] == '1');
+            if (is_escape) {
+                token.key.push_back(raw[++i] == '0' ? '~' : '/');
+            } else {
+                token.key.push_back(raw[i]);
+            }
+        }
+
+        token.hash  = hash_key(token.key);
+        token.index = as_index(raw);
+
+        // slices keep their key, as objects may still have a member named e.g. "0:10"
+        if (const auto colon = raw.find(':'); extended && colon != std::string_view::npos) {
+            const auto from = raw.substr(0, colon);
+            const auto to   = raw.substr(colon + 1);
+            if ((from.empty() || as_index(from)) && (to.empty() || as_index(to))) {
+                token.is_slice    = true;
+                token.slice_start = from.empty() ? 0 : *as_index(from);
+                token.slice_end   = to.empty() ? token.slice_end : *as_index(to);
+            }
+        }
+
+        out.push_back(std::move(token));
+    }
+
+    return out;
+}
+
+
+/**
+ * @brief Whether any of `tokens` can match more than one value.
+ */
+inline auto is_fan_out(const std::vector<Token>& tokens) noexcept -> bool {
+    return std::any_of(std::begin(tokens), std::end(tokens), [](const Token& token) {
+        return token.is_wildcard || token.is_slice;
+    });
+}
+
+
+/**
+ * @brief Call `fun` on every value that `tokens[depth:]` reaches from `element`.
+ *
+ * Values are visited in document order. Tokens that don't match (missing keys, out-of-bounds or
+ * non-numeric indices, or anything below a scalar) are silently skipped.
+ */
+template <typename fun_T>
+inline void for_each_match(simdjson::dom::element    element,
+                           const std::vector<Token>& tokens,
+                           const std::size_t         depth,
+                           fun_T&                    fun) {
+    if (depth == std::size(tokens)) {
+        fun(element);
+        return;
+    }
+
+    const auto& token = tokens[depth];
+    switch (element.type()) {
+        case simdjson::dom::element_type::ARRAY: {
+            const auto array = simdjson::dom::array(element);
+            if (token.is_wildcard) {
+                for (auto child : array) {
+                    for_each_match(child, tokens, depth + 1, fun);
+                }
+            } else if (token.is_slice) {
+                auto i = std::size_t(0);
+                for (auto child : array) {
+                    if (i >= token.slice_end) {
+                        break;
+                    }
+                    if (i++ >= token.slice_start) {
+                        for_each_match(child, tokens, depth + 1, fun);
+                    }
+                }
+            } else if (simdjson::dom::element child;
+                       token.index && array.at(*token.index).get(child) == simdjson::SUCCESS) {
+                for_each_match(child, tokens, depth + 1, fun);
+            }
+            break;
+        }
+
+        case simdjson::dom::element_type::OBJECT: {
+            const auto object = simdjson::dom::object(element);
+            if (token.is_wildcard) {
+                for (auto [key, value] : object) {
+                    for_each_match(value, tokens, depth + 1, fun);
+                }
+            } else if (simdjson::dom::element child;
+                       object.at_key(token.key).get(child) == simdjson::SUCCESS) {
+                for_each_match(child, tokens, depth + 1, fun);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief A set of JSON Pointers compiled into a prefix trie, so that all of them are resolved
+ * against a document in a single traversal that visits shared prefixes only once.
+ *
+ * Only pointers without wildcards or slices are compiled into the trie; the others are kept as
+ * tokens (see fan_out()). Anything else (`NA`, `""`, malformed pointers) is left unresolved, as
+ * are pointers that aren't found, so that callers can fall back to evaluating them one by one,
+ * errors included. A node's children are keyed on the hashes their tokens computed up front, so
+ * each key of a document is hashed once and compared to at most the children sharing its hash.
+ *
+ * A Query_Trie is what `json_pointer()` compiles, so it can also outlive a single call.
+ */
+class Query_Trie {
+    struct Node {
+        std::string                                       key; // of the token leading here
+        std::unordered_multimap<std::size_t, std::size_t> children; // (hash_key(), child)
+        std::vector<std::pair<std::size_t, std::size_t>>  indices;  // sorted (index, child)
+        std::vector<std::size_t>                          slots;
+    };
+
+    std::vector<Node>                                  nodes;
+    std::vector<std::optional<std::vector<Token>>>     fan_outs;
+    std::vector<std::optional<simdjson::dom::element>> found;
+    std::vector<bool>                                  visited;
+
+    inline auto find_child(std::size_t node, std::string_view key, std::size_t hash) const
+        -> std::optional<std::size_t>;
+
+    inline void walk(simdjson::dom::element element, std::size_t node);
+
+  public:
+    explicit Query_Trie(const Rcpp::CharacterVector& query);
+
+    /**
+     * @brief The element each query resolves to in `parsed`, or std::nullopt.
+     *
+     * The result is only valid until the next call.
+     */
+    inline auto resolve(simdjson::dom::element parsed)
+        -> const std::vector<std::optional<simdjson::dom::element>>&;
+
+    /**
+     * @brief The tokens of query `i` if it has wildcards or slices, or std::nullopt.
+     */
+    [[nodiscard]] auto fan_out(const std::size_t i) const noexcept
+        -> const std::optional<std::vector<Token>>& {
+        return fan_outs[i];
+    }
+};
+
+
+inline Query_Trie::Query_Trie(const Rcpp::CharacterVector& query)
+    : nodes(1), fan_outs(std::size(query)), found(std::size(query)) {
+
+    for (R_xlen_t i = 0; i < r_length(query); ++i) {
+        if (STRING_ELT(query, i) == NA_STRING) {
+            continue;
+        }
+        const auto path = std::string_view(CHAR(STRING_ELT(query, i)));
+
+        // `at_pointer()` rejects any `~` that isn't `~0` or `~1`, so leave those to it
+        auto is_valid = !path.empty();
+        for (auto tilde = path.find('~'); is_valid && tilde != std::string_view::npos;
+             tilde      = path.find('~', tilde + 1)) {
+            const auto escaped = tilde + 1 < std::size(path) ? path[tilde + 1] : '\0';
+            is_valid           = escaped == '0' || escaped == '1';
+        }
+        auto tokens = is_valid ? tokenize(path) : std::nullopt;
+        if (!tokens) {
+            continue;
+        }
+        if (is_fan_out(*tokens)) {
+            fan_outs[i] = std::move(tokens);
+            continue;
+        }
+
+        auto node = std::size_t(0);
+        for (const auto& token : *tokens) {
+            auto child = find_child(node, token.key, token.hash);
+            if (!child) {
+                child = std::size(nodes);
+                nodes[node].children.emplace(token.hash, *child);
+                if (token.index) {
+                    nodes[node].indices.emplace_back(*token.index, *child);
+                }
+                nodes.emplace_back().key = token.key;
+            }
+            node = *child;
+        }
+        nodes[node].slots.push_back(i);
+    }
+
+    for (auto& node : nodes) {
+        std::sort(std::begin(node.indices), std::end(node.indices));
+    }
+    visited.resize(std::size(nodes));
+}
+
+
+inline auto Query_Trie::resolve(simdjson::dom::element parsed)
+    -> const std::vector<std::optional<simdjson::dom::element>>& {
+    std::fill(std::begin(found), std::end(found), std::nullopt);
+    std::fill(std::begin(visited), std::end(visited), false);
+    walk(parsed, 0);
+    return found;
+}
+
+
+/**
+ * @brief The child of `node` reached by `key`, whose hash_key() is `hash`, if there is one.
+ */
+inline auto Query_Trie::find_child(const std::size_t      node,
+                                   const std::string_view key,
+                                   const std::size_t      hash) const
+    -> std::optional<std::size_t> {
+    // colliding hashes are told apart by the children's own keys
+    const auto [first, last] = nodes[node].children.equal_range(hash);
+    for (auto child = first; child != last; ++child) {
+        if (nodes[child->second].key == key) {
+            return child->second;
+        }
+    }
+    return std::nullopt;
+}
+
+
+inline void Query_Trie::walk(simdjson::dom::element element, const std::size_t node) {
+    for (const auto slot : nodes[node].slots) {
+        found[slot] = element;
+    }
+
+    const auto& [key, children, indices, slots] = nodes[node];
+    switch (element.type()) {
+        case simdjson::dom::element_type::ARRAY: {
+            auto next = std::begin(indices);
+            auto i    = std::size_t(0);
+            for (auto child : simdjson::dom::array(element)) {
+                if (next == std::end(indices)) {
+                    break;
+                }
+                if (i++ == next->first) {
+                    walk(child, (next++)->second);
+                }
+            }
+            break;
+        }
+
+        case simdjson::dom::element_type::OBJECT: {
+            // one child is cheaper to look up than to scan for, and equivalent to `at_pointer()`
+            if (std::size(children) == 1) {
+                const auto only_child = std::begin(children)->second;
+                if (simdjson::dom::element child; simdjson::dom::object(element)
+                                                      .at_key(nodes[only_child].key)
+                                                      .get(child) == simdjson::SUCCESS) {
+                    walk(child, only_child);
+                }
+                break;
+            }
+
+            auto n_visited = std::size_t(0);
+            for (auto [member_key, value] : simdjson::dom::object(element)) {
+                // like `at_key()`, only the first of any duplicated keys is followed
+                if (const auto child = find_child(node, member_key, hash_key(member_key));
+                    child && !visited[*child]) {
+                    visited[*child] = true;
+                    walk(value, *child);
+                    if (++n_visited == std::size(children)) {
+                        break;
+                    }
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+
+} // namespace pointer
+} // namespace rcppsimdjson
+
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef RCPPSIMDJSON_RECORDS_HPP
+#define RCPPSIMDJSON_RECORDS_HPP
+
+
+#include "common.hpp"
+
+#include <algorithm>   /* std::copy, std::max */
+#include <cstdio>      /* std::FILE, std::fopen, std::fread, std::fclose */
+#include <memory>      /* std::unique_ptr */
+#include <optional>    /* std::optional */
+#include <string>      /* std::string */
+#include <string_view> /* std::string_view */
+#include <vector>      /* std::vector */
+
+
+namespace rcppsimdjson {
+namespace records {
+
+
+/**
+ * @brief The bytes of a file read at a time.
+ */
+inline constexpr std::size_t CHUNK_SIZE = 1 << 24;
+
+
+/**
+ * @brief Turns a top-level JSON array into a stream of whitespace-separated documents, in place,
+ * by blanking out its brackets and the commas between its elements, so that `parse_many()` can
+ * stream its elements like the records of an NDJSON file.
+ *
+ * Only strings, nesting, and the commas between elements are tracked, so bytes can be fed a
+ * chunk at a time; the elements themselves are left for `parse_many()` to validate.
+ */
+class Array_Splitter {
+    int  depth        = 0;
+    bool is_open      = false;
+    bool is_closed    = false;
+    bool in_string    = false;
+    bool is_escaped   = false;
+    bool is_expecting = false; /* for an element, after `[` or `,` */
+    bool has_elements = false;
+
+  public:
+    /**
+     * @brief Rewrite `bytes[from, size)`, which follow the `bytes[0, from)` of previous calls.
+     *
+     * @return The end of the last complete element of `bytes[0, size)`.
+     */
+    inline auto split(char* bytes, std::size_t from, std::size_t size) -> std::size_t;
+
+    [[nodiscard]] auto is_complete() const noexcept -> bool { return is_closed; }
+};
+
+
+inline auto
+Array_Splitter::split(char* const bytes, const std::size_t from, const std::size_t size)
+    -> std::size_t {
+    const auto is_space = [](const char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    };
+    auto end = std::size_t(0);
+
+    for (auto i = from; i < size; ++i) {
+        const auto c = bytes[i];
+        if (in_string) {
+            if (is_escaped) {
+                is_escaped = false;
+            } else if (c == '\\') {
+                is_escaped = true;
+            } else if (c == '"') {
+                in_string = false;
+            }
+            continue;
+        }
+        if (is_space(c)) {
+            continue;
+        }
+        if (is_closed) {
+            Rcpp::stop("Unexpected content after the top-level JSON array.");
+        }
+
+        if (!is_open) {
+            bytes[i]     = ' ';
+            is_open      = true;
+            is_expecting = true;
+            depth        = 1;
+            end          = i + 1;
+            continue;
+        }
+
+        if (depth == 1 && (c == ',' || c == ']')) {
+            if (is_expecting && (c == ',' || has_elements)) {
+                Rcpp::stop("The top-level JSON array has an empty element.");
+            }
+            bytes[i]     = ' ';
+            is_expecting = true;
+            is_closed    = c == ']';
+            end          = i + 1;
+            continue;
+        }
+
+        if (is_expecting) {
+            is_expecting = false;
+            has_elements = true;
+        }
+        switch (c) {
+            case '"':
+                in_string = true;
+                break;
+
+            case '[':
+            case '{':
+                ++depth;
+                break;
+
+            case ']':
+            case '}':
+                --depth;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return end;
+}
+
+
+/**
+ * @brief Call `fun(record)` for each record of the file at `path`, streaming them with
+ * `parse_many()`.
+ *
+ * Records are either the lines of an NDJSON file or, if the file starts with `[`, the elements of
+ * a top-level JSON array. The file is read a chunk (up to its last newline, or the last element
+ * of the array) at a time, so only a chunk is ever in memory, unless a single record is larger.
+ * Files with a `memDecompress()`-compatible extension are decompressed into memory first.
+ *
+ * @return The number of records.
+ */
+template <typename fun_T>
+inline auto for_each_record(const std::string& path, fun_T&& fun) -> int64_t {
+    simdjson::dom::parser parser;
+    auto                  n_records = int64_t(0);
+    auto                  is_array  = std::optional<bool>();
+    auto                  splitter  = Array_Splitter();
+
+    const auto parse_records = [&parser, &n_records, &fun](const char*       bytes,
+                                                           const std::size_t size) {
+        simdjson::dom::document_stream records;
+        if (const auto error =
+                parser.parse_many(bytes, size, std::max(size, simdjson::dom::DEFAULT_BATCH_SIZE))
+                    .get(records);
+            error != simdjson::SUCCESS) {
+            Rcpp::stop(simdjson::error_message(error));
+        }
+        for (auto record : records) {
+            simdjson::dom::element element;
+            if (const auto error = record.get(element); error != simdjson::SUCCESS) {
+                Rcpp::stop("Record " + std::to_string(n_records + 1) + ": " +
+                           simdjson::error_message(error));
+            }
+            fun(element);
+            ++n_records;
+        }
+        if (records.truncated_bytes() > 0) {
+            Rcpp::stop("Record " + std::to_string(n_records + 1) + ": " +
+                       simdjson::error_message(simdjson::TAPE_ERROR));
+        }
+    };
+
+    // the end of the records complete in `bytes[0, size)`, which are new from `from` on
+    const auto split_records = [&is_array, &splitter](char* const       bytes,
+                                                      const std::size_t from,
+                                                      const std::size_t size,
+                                                      const bool        is_eof) -> std::size_t {
+        if (!is_array) {
+            const auto first = std::string_view(bytes, size).find_first_not_of(" \t\n\r");
+            if (first == std::string_view::npos) {
+                return is_eof ? size : 0;
+            }
+            is_array = bytes[first] == '[';
+        }
+
+        if (*is_array) {
+            const auto end = splitter.split(bytes, from, size);
+            if (is_eof && !splitter.is_complete()) {
+                Rcpp::stop("The top-level JSON array is never closed.");
+            }
+            return is_eof ? size : end;
+        }
+
+        if (is_eof) {
+            return size;
+        }
+        const auto last_newline = std::string_view(bytes, size).find_last_of('\n');
+        return last_newline == std::string_view::npos ? 0 : last_newline + 1;
+    };
+
+    if (const auto file_type = utils::get_memDecompress_type(std::string_view(path))) {
+        const auto raw    = utils::decompress(path, Rcpp::String(std::string(*file_type)));
+        auto       padded = simdjson::padded_string(reinterpret_cast<const char*>(&(raw[0])),
+                                              std::size(raw));
+        if (const auto end = split_records(padded.data(), 0, std::size(padded), true); end > 0) {
+            parse_records(padded.data(), end);
+        }
+        return n_records;
+    }
+
+    auto file = std::unique_ptr<std::FILE, decltype(&std::fclose)>(std::fopen(path.c_str(), "rb"),
+                                                                   &std::fclose);
+    if (!file) {
+        Rcpp::stop("Failed to open '" + path + "'.");
+    }
+
+    auto buffer  = std::vector<char>();
+    auto n_carry = std::size_t(0); /* the bytes after the last chunk's last record */
+    for (auto is_eof = false; !is_eof;) {
+        buffer.resize(n_carry + CHUNK_SIZE + simdjson::SIMDJSON_PADDING);
+        const auto n_read = std::fread(buffer.data() + n_carry, 1, CHUNK_SIZE, file.get());
+        const auto size   = n_carry + n_read;
+        is_eof            = n_read < CHUNK_SIZE;
+
+        const auto end = split_records(buffer.data(), n_carry, size, is_eof);
+        if (end > 0) {
+            parse_records(buffer.data(), end);
+        }
+
+        std::copy(buffer.data() + end, buffer.data() + size, buffer.data());
+        n_carry = size - end;
+    }
+
+    return n_records;
+}
+
+
+} // namespace records
+} // namespace rcppsimdjson
+
+
+#endif
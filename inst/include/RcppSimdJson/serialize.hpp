@@ -0,0 +1,474 @@
+#ifndef RCPPSIMDJSON_SERIALIZE_HPP
+#define RCPPSIMDJSON_SERIALIZE_HPP
+
+
+#include "common.hpp"
+
+#include <array>       /* std::array */
+#include <cmath>       /* std::isfinite */
+#include <cstdint>     /* int64_t, uint64_t */
+#include <cstdio>      /* std::FILE, std::fwrite */
+#include <cstring>     /* std::memcpy */
+#include <string>      /* std::string */
+#include <string_view> /* std::string_view */
+#include <vector>      /* std::vector */
+
+
+namespace rcppsimdjson {
+namespace serialize {
+
+
+/**
+ * @brief The index of the first byte of `x` from `from` on that a JSON string must escape (a
+ * control character, `"`, or `\`), or `std::size(x)` if there's none.
+ *
+ * Bytes are tested 8 at a time within a 64-bit word ("SWAR"), which is portable to every platform
+ * R builds on, and only a word that has such a byte is searched one byte at a time.
+ */
+inline auto find_escape(const std::string_view x, std::size_t from) noexcept -> std::size_t {
+    constexpr auto ONES  = uint64_t(0x0101010101010101);
+    constexpr auto HIGHS = uint64_t(0x8080808080808080);
+
+    const auto needs_escape = [](const char c) {
+        return static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\';
+    };
+
+    for (; from + 8 <= std::size(x); from += 8) {
+        uint64_t word;
+        std::memcpy(&word, x.data() + from, 8);
+        const auto quotes      = word ^ (ONES * '"');
+        const auto backslashes = word ^ (ONES * '\\');
+        /* a high bit is set where a byte is < 0x20, or where one of the XORs left a 0 (as `"`
+         * and `\\` are ASCII, `~word` has the same high bits as `~quotes` and `~backslashes`) */
+        if (((word - ONES * 0x20) | (quotes - ONES) | (backslashes - ONES)) & ~word & HIGHS) {
+            break;
+        }
+    }
+    for (; from < std::size(x); ++from) {
+        if (needs_escape(x[from])) {
+            return from;
+        }
+    }
+    return from;
+}
+
+
+/**
+ * @brief Append `x` to `out` as a JSON string, quoted and escaped.
+ */
+inline void write_string(std::string& out, const std::string_view x) {
+    out.push_back('"');
+    auto start = std::size_t(0);
+    for (auto i = find_escape(x, 0); i < std::size(x); i = find_escape(x, start)) {
+        out.append(x.data() + start, i - start);
+        switch (const auto c = x[i]; c) {
+            case '"':
+                out.append("\\\"");
+                break;
+            case '\\':
+                out.append("\\\\");
+                break;
+            case '\b':
+                out.append("\\b");
+                break;
+            case '\f':
+                out.append("\\f");
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            case '\t':
+                out.append("\\t");
+                break;
+            default: {
+                constexpr auto hex = std::string_view("0123456789abcdef");
+                out.append("\\u00");
+                out.push_back(hex[(c >> 4) & 0xF]);
+                out.push_back(hex[c & 0xF]);
+            }
+        }
+        start = i + 1;
+    }
+    out.append(x.data() + start, std::size(x) - start);
+    out.push_back('"');
+}
+
+
+/**
+ * @brief Options that decide how R objects are written.
+ */
+struct Serialize_Opts {
+    bool dataframe_rows = true;  /* data frames as arrays of rows, or objects of columns */
+    bool auto_unbox     = false; /* length-1 atomic vectors as scalars, rather than arrays */
+};
+
+
+/**
+ * @brief What an R vector's elements are written as, decided once per vector rather than per
+ * element.
+ */
+enum class Vector_Kind {
+    lgl,
+    i32,
+    factor,
+    dbl,
+    i64, /* bit64::integer64 */
+    chr,
+    raw,
+    list,
+    data_frame,
+};
+
+
+inline auto classify(SEXP x) -> Vector_Kind {
+    switch (TYPEOF(x)) {
+        case LGLSXP:
+            return Vector_Kind::lgl;
+        case INTSXP:
+            return Rf_isFactor(x) ? Vector_Kind::factor : Vector_Kind::i32;
+        case REALSXP:
+            return Rf_inherits(x, "integer64") ? Vector_Kind::i64 : Vector_Kind::dbl;
+        case STRSXP:
+            return Vector_Kind::chr;
+        case RAWSXP:
+            return Vector_Kind::raw;
+        case VECSXP:
+            return Rf_isFrame(x) ? Vector_Kind::data_frame : Vector_Kind::list;
+        default:
+            Rcpp::stop("Objects of type '" + std::string(Rf_type2char(TYPEOF(x))) +
+                       "' can't be serialized to JSON.");
+    }
+}
+
+
+inline auto get_int64(SEXP x, const R_xlen_t i) noexcept -> int64_t {
+    int64_t value;
+    std::memcpy(&value, &(REAL(x)[i]), sizeof(int64_t));
+    return value;
+}
+
+
+/**
+ * @brief Whether element `i` of `x` is written as `null` (or left out of a data frame's row).
+ */
+inline auto is_na_element(SEXP x, const Vector_Kind kind, const R_xlen_t i) -> bool {
+    switch (kind) {
+        case Vector_Kind::lgl:
+            return LOGICAL(x)[i] == NA_LOGICAL;
+        case Vector_Kind::i32:
+        case Vector_Kind::factor:
+            return INTEGER(x)[i] == NA_INTEGER;
+        case Vector_Kind::dbl:
+            return !std::isfinite(REAL(x)[i]);
+        case Vector_Kind::i64:
+            return get_int64(x, i) == NA_INTEGER64;
+        case Vector_Kind::chr:
+            return STRING_ELT(x, i) == NA_STRING;
+        case Vector_Kind::list:
+            return Rf_isNull(VECTOR_ELT(x, i));
+        default:
+            return false;
+    }
+}
+
+
+/**
+ * @brief A data frame column's kind, and whether it's a matrix, whose rows are written as arrays
+ * (that are never left out) rather than as single elements.
+ */
+struct Column_Kind {
+    Vector_Kind kind;
+    bool        is_matrix;
+};
+
+
+inline auto classify_column(SEXP column) -> Column_Kind {
+    return Column_Kind{classify(column), Rf_xlength(Rf_getAttrib(column, R_DimSymbol)) == 2};
+}
+
+
+/**
+ * @brief Writes R objects as JSON into a single growing buffer, which is flushed to `file` (if
+ * any) whenever it fills up, so files are written without ever holding all of their JSON.
+ *
+ * - `NULL`, `NA`s, and non-finite doubles are `null`s.
+ * - Atomic vectors are arrays (or scalars if `auto_unbox` and of length 1), matrices arrays of
+ *   rows, factors their levels, and `bit64::integer64`s 64-bit integers.
+ * - Lists with names are objects, others arrays.
+ * - Data frames are arrays of row objects, where `NA` fields are left out and a matrix column's
+ *   fields are its rows, or objects of column arrays.
+ */
+class Serializer {
+    static constexpr std::size_t FLUSH_SIZE = 1 << 20;
+
+    Serialize_Opts opts;
+    std::FILE*     file;
+
+    inline void write_vector(SEXP x, Vector_Kind kind);
+    inline void write_matrix(SEXP x, Vector_Kind kind);
+    inline void write_list(SEXP x);
+    inline void write_data_frame(SEXP x);
+    inline void write_row(SEXP x, const std::vector<Column_Kind>& kinds, R_xlen_t i);
+
+    inline void write_key(SEXP key) {
+        write_string(out, Rf_translateCharUTF8(key));
+        out.push_back(':');
+    }
+
+    template <typename number_T>
+    inline void write_number(const number_T x) {
+        std::array<char, utils::NUMBER_BUFFER_SIZE> buffer;
+        const auto end = utils::format_number(buffer.data(), buffer.data() + buffer.size(), x);
+        out.append(buffer.data(), end - buffer.data());
+    }
+
+    inline void flush_if_full() {
+        if (file && std::size(out) >= FLUSH_SIZE) {
+            flush();
+        }
+    }
+
+  public:
+    std::string out = std::string();
+
+    explicit Serializer(const Serialize_Opts& opts, std::FILE* file = nullptr)
+        : opts(opts), file(file) {}
+
+    inline void write_value(SEXP x);
+
+    /**
+     * @brief Write element `i` of `x`, or row `i` if `x` is a data frame.
+     */
+    inline void write_element(SEXP x, Vector_Kind kind, R_xlen_t i);
+
+    /**
+     * @brief Write row `i` of the matrix `x` as an array.
+     */
+    inline void write_matrix_row(SEXP x, Vector_Kind kind, R_xlen_t i);
+
+    inline void flush() {
+        if (std::fwrite(out.data(), 1, std::size(out), file) != std::size(out)) {
+            Rcpp::stop("Failed to write the JSON to the file."); // # nocov
+        }
+        out.clear();
+    }
+};
+
+
+inline void Serializer::write_value(SEXP x) {
+    if (Rf_isNull(x)) {
+        out.append("null");
+        return;
+    }
+
+    switch (const auto kind = classify(x); kind) {
+        case Vector_Kind::list:
+            write_list(x);
+            break;
+
+        case Vector_Kind::data_frame:
+            write_data_frame(x);
+            break;
+
+        default:
+            if (Rf_xlength(Rf_getAttrib(x, R_DimSymbol)) == 2) {
+                write_matrix(x, kind);
+            } else if (opts.auto_unbox && Rf_xlength(x) == 1) {
+                write_element(x, kind, 0);
+            } else {
+                write_vector(x, kind);
+            }
+            break;
+    }
+}
+
+
+inline void Serializer::write_element(SEXP x, const Vector_Kind kind, const R_xlen_t i) {
+    if (is_na_element(x, kind, i)) {
+        out.append("null");
+        return;
+    }
+
+    switch (kind) {
+        case Vector_Kind::lgl:
+            out.append(LOGICAL(x)[i] ? "true" : "false");
+            break;
+
+        case Vector_Kind::i32:
+            write_number(INTEGER(x)[i]);
+            break;
+
+        case Vector_Kind::factor:
+            write_string(out, Rf_translateCharUTF8(
+                                  STRING_ELT(Rf_getAttrib(x, R_LevelsSymbol), INTEGER(x)[i] - 1)));
+            break;
+
+        case Vector_Kind::dbl:
+            write_number(REAL(x)[i]);
+            break;
+
+        case Vector_Kind::i64:
+            write_number(get_int64(x, i));
+            break;
+
+        case Vector_Kind::chr:
+            write_string(out, Rf_translateCharUTF8(STRING_ELT(x, i)));
+            break;
+
+        case Vector_Kind::raw:
+            write_number(static_cast<int>(RAW(x)[i]));
+            break;
+
+        case Vector_Kind::list:
+            write_value(VECTOR_ELT(x, i));
+            break;
+
+        case Vector_Kind::data_frame: {
+            auto kinds = std::vector<Column_Kind>();
+            for (R_xlen_t j = 0; j < Rf_xlength(x); ++j) {
+                kinds.push_back(classify_column(VECTOR_ELT(x, j)));
+            }
+            write_row(x, kinds, i);
+            break;
+        }
+    }
+}
+
+
+inline void Serializer::write_vector(SEXP x, const Vector_Kind kind) {
+    out.push_back('[');
+    for (R_xlen_t i = 0; i < Rf_xlength(x); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        write_element(x, kind, i);
+        flush_if_full();
+    }
+    out.push_back(']');
+}
+
+
+inline void Serializer::write_matrix(SEXP x, const Vector_Kind kind) {
+    const auto n_rows = static_cast<R_xlen_t>(INTEGER(Rf_getAttrib(x, R_DimSymbol))[0]);
+
+    out.push_back('[');
+    for (R_xlen_t i = 0; i < n_rows; ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        write_matrix_row(x, kind, i);
+        flush_if_full();
+    }
+    out.push_back(']');
+}
+
+
+inline void Serializer::write_matrix_row(SEXP x, const Vector_Kind kind, const R_xlen_t i) {
+    const auto dim    = Rf_getAttrib(x, R_DimSymbol);
+    const auto n_rows = static_cast<R_xlen_t>(INTEGER(dim)[0]);
+    const auto n_cols = static_cast<R_xlen_t>(INTEGER(dim)[1]);
+
+    out.push_back('[');
+    for (R_xlen_t j = 0; j < n_cols; ++j) {
+        if (j > 0) {
+            out.push_back(',');
+        }
+        write_element(x, kind, i + j * n_rows); /* column-major */
+    }
+    out.push_back(']');
+}
+
+
+inline void Serializer::write_list(SEXP x) {
+    const auto names     = Rf_getAttrib(x, R_NamesSymbol);
+    const auto is_object = !Rf_isNull(names);
+
+    out.push_back(is_object ? '{' : '[');
+    for (R_xlen_t i = 0; i < Rf_xlength(x); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        if (is_object) {
+            write_key(STRING_ELT(names, i));
+        }
+        write_value(VECTOR_ELT(x, i));
+        flush_if_full();
+    }
+    out.push_back(is_object ? '}' : ']');
+}
+
+
+inline void Serializer::write_data_frame(SEXP x) {
+    const auto names = Rf_getAttrib(x, R_NamesSymbol);
+    auto       kinds = std::vector<Column_Kind>();
+    for (R_xlen_t j = 0; j < Rf_xlength(x); ++j) {
+        kinds.push_back(classify_column(VECTOR_ELT(x, j)));
+    }
+
+    if (!opts.dataframe_rows) {
+        /* an object of columns, which are arrays even if of length 1 */
+        out.push_back('{');
+        for (R_xlen_t j = 0; j < Rf_xlength(x); ++j) {
+            if (j > 0) {
+                out.push_back(',');
+            }
+            write_key(STRING_ELT(names, j));
+            if (const auto column = VECTOR_ELT(x, j); kinds[j].kind == Vector_Kind::data_frame) {
+                write_data_frame(column);
+            } else if (kinds[j].is_matrix) {
+                write_matrix(column, kinds[j].kind);
+            } else {
+                write_vector(column, kinds[j].kind);
+            }
+        }
+        out.push_back('}');
+        return;
+    }
+
+    const auto n_rows = Rf_xlength(Rf_getAttrib(x, R_RowNamesSymbol));
+    out.push_back('[');
+    for (R_xlen_t i = 0; i < n_rows; ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        write_row(x, kinds, i);
+        flush_if_full();
+    }
+    out.push_back(']');
+}
+
+
+inline void
+Serializer::write_row(SEXP x, const std::vector<Column_Kind>& kinds, const R_xlen_t i) {
+    const auto names = Rf_getAttrib(x, R_NamesSymbol);
+
+    out.push_back('{');
+    auto is_first = true;
+    for (R_xlen_t j = 0; j < Rf_xlength(x); ++j) {
+        const auto column = VECTOR_ELT(x, j);
+        if (!kinds[j].is_matrix && is_na_element(column, kinds[j].kind, i)) {
+            continue;
+        }
+        if (!is_first) {
+            out.push_back(',');
+        }
+        is_first = false;
+        write_key(STRING_ELT(names, j));
+        if (kinds[j].is_matrix) {
+            write_matrix_row(column, kinds[j].kind, i);
+        } else {
+            write_element(column, kinds[j].kind, i);
+        }
+    }
+    out.push_back('}');
+}
+
+
+} // namespace serialize
+} // namespace rcppsimdjson
+
+
+#endif
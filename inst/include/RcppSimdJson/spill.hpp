@@ -0,0 +1,820 @@
+#ifndef RCPPSIMDJSON_SPILL_HPP
+#define RCPPSIMDJSON_SPILL_HPP
+
+
+#include "deserialize.hpp"
+
+#include "records.hpp"
+
+#include <algorithm>   /* std::copy_n, std::min */
+#include <array>       /* std::array */
+#include <cerrno>      /* errno */
+#include <cstring>     /* std::strerror */
+#include <deque>       /* std::deque */
+#include <fstream>     /* std::ifstream */
+#include <functional>  /* std::function */
+#include <memory>      /* std::make_shared, std::shared_ptr */
+#include <string>      /* std::string */
+#include <type_traits> /* std::conditional_t */
+#include <utility>     /* std::move, std::pair */
+#include <vector>      /* std::vector */
+
+/* spilled columns are ALTREP vectors over memory-mapped files, so they need both */
+#if defined(RCPPSIMDJSON_HAS_ALTREP) && !defined(_WIN32)
+#    include <sys/mman.h> /* mmap(), munmap() */
+#    include <unistd.h>   /* close(), mkstemp(), unlink(), write() */
+#    define RCPPSIMDJSON_HAS_SPILL
+#endif
+
+
+namespace rcppsimdjson {
+namespace deserialize {
+namespace spill {
+
+
+#ifdef RCPPSIMDJSON_HAS_SPILL
+
+/**
+ * @brief The bytes written to a spill file at a time while it's being created.
+ */
+inline constexpr std::size_t CHUNK_SIZE = 1 << 20;
+
+
+/**
+ * @brief An anonymous temporary file in `dir`, mapped into memory.
+ *
+ * The file is unlinked as soon as it's created, so it never outlives the mapping (or the R
+ * session) and is never seen by anyone else. Its pages are backed by the file rather than swap, so
+ * the OS can drop them under memory pressure and read them back when they're next used.
+ */
+class Mapped_File {
+    std::string dir;
+    int         fd      = -1;
+    void*       data    = nullptr;
+    std::size_t n_bytes = 0;
+
+    [[noreturn]] void fail() const {
+        const auto message = std::string(std::strerror(errno));
+        Rcpp::stop("Failed to spill a column to '" + dir + "': " + message);
+    }
+
+  public:
+    /**
+     * @brief An empty file, to append() to and then map().
+     */
+    explicit Mapped_File(std::string dir) : dir(std::move(dir)) {
+        auto path = this->dir + "/RcppSimdJson-XXXXXX";
+        if (fd = mkstemp(path.data()); fd == -1) {
+            fail();
+        }
+        unlink(path.c_str());
+    }
+
+    /**
+     * @brief A mapped file of `n` copies of `value`.
+     *
+     * The file is written out chunk by chunk rather than merely truncated to size, so that running
+     * out of disk space is an error now instead of a `SIGBUS` when the mapping is later written to.
+     */
+    template <typename value_T>
+    Mapped_File(std::string dir, const std::size_t n, const value_T value)
+        : Mapped_File(std::move(dir)) {
+        auto chunk = std::vector<value_T>(std::min(n, CHUNK_SIZE / sizeof(value_T)), value);
+        for (auto n_left = n; n_left != 0;) {
+            const auto n_chunk = std::min(n_left, std::size(chunk));
+            append(reinterpret_cast<const char*>(chunk.data()), n_chunk * sizeof(value_T));
+            n_left -= n_chunk;
+        }
+        map();
+    }
+
+    Mapped_File(const Mapped_File&) = delete;
+    auto operator=(const Mapped_File&) -> Mapped_File& = delete;
+
+    ~Mapped_File() {
+        if (data) {
+            munmap(data, n_bytes);
+        }
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    /**
+     * @brief Write `bytes[0, n)` to the end of the file, which mustn't be mapped yet.
+     */
+    void append(const char* bytes, const std::size_t n) {
+        for (auto n_left = n; n_left != 0;) {
+            const auto n_written = write(fd, bytes, n_left);
+            if (n_written == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fail();
+            }
+            bytes += n_written;
+            n_left -= n_written;
+        }
+        n_bytes += n;
+    }
+
+    /**
+     * @brief Map the file into memory, unless it's empty.
+     */
+    void map() {
+        if (n_bytes == 0) {
+            return;
+        }
+        if (data = mmap(nullptr, n_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            data == MAP_FAILED) {
+            data = nullptr;
+            fail();
+        }
+    }
+
+    template <typename value_T>
+    auto get() const noexcept -> value_T* {
+        return static_cast<value_T*>(data);
+    }
+
+    auto size() const noexcept -> std::size_t { return n_bytes; }
+};
+
+
+/**
+ * @brief Where a spilled string's bytes are in its column's file of bytes. NA if `length < 0`.
+ */
+struct Span {
+    int64_t start  = 0;
+    int64_t length = -1;
+};
+
+
+template <int RTYPE>
+using value_type = std::conditional_t<RTYPE == REALSXP, double, int>;
+
+
+/**
+ * @brief The package's ALTREP class for spilled columns of `RTYPE`, registered by
+ * `R_init_RcppSimdJson()`.
+ */
+template <int RTYPE>
+inline auto spilled_class() -> R_altrep_class_t& {
+    static auto altrep_class = R_altrep_class_t{nullptr};
+    return altrep_class;
+}
+
+
+inline auto is_registered() -> bool { return spilled_class<REALSXP>().ptr != nullptr; }
+
+
+/**
+ * @brief A double, integer, or logical vector whose data is a Mapped_File (its `data1`).
+ */
+template <int RTYPE>
+struct Spilled_Column {
+    using value_T = value_type<RTYPE>;
+
+    static auto file(SEXP x) -> Mapped_File& {
+        return *static_cast<Mapped_File*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+    }
+
+    static R_xlen_t Length(SEXP x) { return file(x).size() / sizeof(value_T); }
+
+    static value_T Elt(SEXP x, R_xlen_t i) { return file(x).template get<value_T>()[i]; }
+
+    static R_xlen_t Get_region(SEXP x, R_xlen_t i, R_xlen_t n, value_T* out) {
+        const auto n_copied = std::min(n, Length(x) - i);
+        std::copy_n(file(x).template get<value_T>() + i, n_copied, out);
+        return n_copied;
+    }
+
+    static void* Dataptr(SEXP x, Rboolean /* writeable */) {
+        return file(x).template get<value_T>();
+    }
+
+    static const void* Dataptr_or_null(SEXP x) { return file(x).template get<value_T>(); }
+
+    static Rboolean
+    Inspect(SEXP x, int /* pre */, int /* deep */, int /* pvec */, void (*)(SEXP, int, int, int)) {
+        Rprintf("spilled JSON column (%td elements, %zu bytes mapped from a file)\n",
+                Length(x),
+                file(x).size());
+        return TRUE;
+    }
+};
+
+
+/**
+ * @brief A character vector whose strings are Spans of a Mapped_File of their bytes.
+ *
+ * `data1` is a list of the file of Spans and the file of bytes. Strings are only made into
+ * `CHARSXP`s as they're accessed, unless its data is asked for, which (like compact.hpp's) expands
+ * it into an ordinary character vector, its `data2`.
+ */
+struct Spilled_Strings {
+    static auto file(SEXP x, const R_xlen_t which) -> Mapped_File& {
+        return *static_cast<Mapped_File*>(
+            R_ExternalPtrAddr(VECTOR_ELT(R_altrep_data1(x), which)));
+    }
+
+    static auto is_expanded(SEXP x) -> bool { return R_altrep_data2(x) != R_NilValue; }
+
+    static SEXP string(SEXP x, const R_xlen_t i) {
+        const auto span = file(x, 0).get<Span>()[i];
+        if (span.length < 0) {
+            return NA_STRING;
+        }
+        if (span.length == 0) {
+            return R_BlankString;
+        }
+        return Rf_mkCharLenCE(file(x, 1).get<char>() + span.start, int(span.length), CE_UTF8);
+    }
+
+    static SEXP expanded(SEXP x) {
+        if (!is_expanded(x)) {
+            const auto n   = Length(x);
+            auto       out = Rcpp::CharacterVector(n);
+            for (R_xlen_t i = 0; i < n; ++i) {
+                SET_STRING_ELT(out, i, string(x, i));
+            }
+            R_set_altrep_data2(x, out);
+        }
+        return R_altrep_data2(x);
+    }
+
+    static R_xlen_t Length(SEXP x) { return file(x, 0).size() / sizeof(Span); }
+
+    /* once expanded, the data may have been written to, so it's all that can be trusted */
+    static SEXP Elt(SEXP x, R_xlen_t i) {
+        return is_expanded(x) ? STRING_ELT(R_altrep_data2(x), i) : string(x, i);
+    }
+
+    static void Set_elt(SEXP x, R_xlen_t i, SEXP value) { SET_STRING_ELT(expanded(x), i, value); }
+
+    static void* Dataptr(SEXP x, Rboolean /* writeable */) { return DATAPTR(expanded(x)); }
+
+    static const void* Dataptr_or_null(SEXP x) {
+        return is_expanded(x) ? DATAPTR(R_altrep_data2(x)) : nullptr;
+    }
+
+    static Rboolean
+    Inspect(SEXP x, int /* pre */, int /* deep */, int /* pvec */, void (*)(SEXP, int, int, int)) {
+        Rprintf("spilled JSON column (%td strings, %zu bytes mapped from a file%s)\n",
+                Length(x),
+                file(x, 1).size(),
+                is_expanded(x) ? ", expanded" : "");
+        return TRUE;
+    }
+};
+
+
+template <int RTYPE>
+inline void register_class(R_altrep_class_t altrep_class) {
+    using Methods = std::conditional_t<RTYPE == STRSXP, Spilled_Strings, Spilled_Column<RTYPE>>;
+
+    spilled_class<RTYPE>() = altrep_class;
+    R_set_altrep_Length_method(altrep_class, Methods::Length);
+    R_set_altrep_Inspect_method(altrep_class, Methods::Inspect);
+    R_set_altvec_Dataptr_method(altrep_class, Methods::Dataptr);
+    R_set_altvec_Dataptr_or_null_method(altrep_class, Methods::Dataptr_or_null);
+
+    if constexpr (RTYPE == REALSXP) {
+        R_set_altreal_Elt_method(altrep_class, Methods::Elt);
+        R_set_altreal_Get_region_method(altrep_class, Methods::Get_region);
+    } else if constexpr (RTYPE == INTSXP) {
+        R_set_altinteger_Elt_method(altrep_class, Methods::Elt);
+        R_set_altinteger_Get_region_method(altrep_class, Methods::Get_region);
+    } else if constexpr (RTYPE == LGLSXP) {
+        R_set_altlogical_Elt_method(altrep_class, Methods::Elt);
+        R_set_altlogical_Get_region_method(altrep_class, Methods::Get_region);
+    } else {
+        R_set_altstring_Elt_method(altrep_class, Methods::Elt);
+        R_set_altstring_Set_elt_method(altrep_class, Methods::Set_elt);
+    }
+}
+
+
+inline void register_classes(DllInfo* dll) {
+    register_class<REALSXP>(R_make_altreal_class("spilled_json_dbl_column", "RcppSimdJson", dll));
+    register_class<INTSXP>(
+        R_make_altinteger_class("spilled_json_int_column", "RcppSimdJson", dll));
+    register_class<LGLSXP>(
+        R_make_altlogical_class("spilled_json_lgl_column", "RcppSimdJson", dll));
+    register_class<STRSXP>(
+        R_make_altstring_class("spilled_json_chr_column", "RcppSimdJson", dll));
+}
+
+
+/**
+ * @brief A column being built into a spill file, indexed like the `Rcpp::Vector<RTYPE>` that
+ * fill_col() would otherwise fill.
+ */
+template <int RTYPE>
+class Column {
+    using value_T = value_type<RTYPE>;
+
+    Rcpp::XPtr<Mapped_File> file;
+    value_T*                data;
+
+  public:
+    Column(const std::string& dir, const R_xlen_t n, const value_T na)
+        : file(new Mapped_File(dir, n, na), true), data(file->template get<value_T>()) {}
+
+    auto operator[](const R_xlen_t i) noexcept -> value_T& { return data[i]; }
+
+    auto vector() const -> SEXP { return R_new_altrep(spilled_class<RTYPE>(), file, R_NilValue); }
+};
+
+
+/**
+ * @brief A character column being built into two spill files, indexed like the
+ * `Rcpp::CharacterVector` that fill_col() would otherwise fill.
+ *
+ * Each string's bytes are appended to one file (a buffer's worth at a time) and its Span is written
+ * to the other, so its elements must be assigned in order.
+ */
+class String_Column {
+    Rcpp::XPtr<Mapped_File> spans;
+    Rcpp::XPtr<Mapped_File> bytes;
+    std::string             buffer;
+    int64_t                 n_bytes = 0;
+
+    void flush() {
+        bytes->append(buffer.data(), std::size(buffer));
+        buffer.clear();
+    }
+
+  public:
+    class Element {
+        String_Column& column;
+        const R_xlen_t i;
+
+      public:
+        Element(String_Column& column, const R_xlen_t i) noexcept : column(column), i(i) {}
+
+        void operator=(const Rcpp::String& value) { column.set(i, value); }
+    };
+
+    String_Column(const std::string& dir, const R_xlen_t n)
+        : spans(new Mapped_File(dir, n, Span()), true), bytes(new Mapped_File(dir), true) {}
+
+    auto operator[](const R_xlen_t i) noexcept -> Element { return Element(*this, i); }
+
+    void set(const R_xlen_t i, const Rcpp::String& value) {
+        const auto string = value.get_sexp();
+        if (string == NA_STRING) {
+            return;
+        }
+        const auto length = int64_t(LENGTH(string));
+        spans->get<Span>()[i] = Span{n_bytes, length};
+        buffer.append(CHAR(string), length);
+        n_bytes += length;
+        if (std::size(buffer) >= CHUNK_SIZE) {
+            flush();
+        }
+    }
+
+    auto vector() -> SEXP {
+        flush();
+        bytes->map();
+        return R_new_altrep(
+            spilled_class<STRSXP>(), Rcpp::List::create(spans, bytes), R_NilValue);
+    }
+};
+
+
+/**
+ * @brief The rows of `column` from `i_row` on, so that fill_col() can fill one row at a time.
+ */
+template <typename column_T>
+struct Rows_From {
+    column_T&      column;
+    const R_xlen_t i_row;
+
+    auto operator[](const R_xlen_t i) -> decltype(auto) { return column[i_row + i]; }
+};
+
+
+template <int RTYPE,
+          typename scalar_T,
+          rcpp_T R_Type,
+          typename column_T,
+          Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt>
+inline auto spill_col(column_T                                   column,
+                      const simdjson::dom::array                 array,
+                      const std::string_view                     key,
+                      const Type_Doctor<type_policy, int64_opt>& type_doc) -> SEXP {
+    fill_col<RTYPE, scalar_T, R_Type>(array, key, type_doc, column);
+    return column.vector();
+}
+
+
+/**
+ * @brief Build a column like build_column() does, but into spill files if it's double, integer,
+ * logical, integer64, or character. Other columns are built as usual.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline auto spill_column(const simdjson::dom::array                 array,
+                         const std::string_view                     key,
+                         const Type_Doctor<type_policy, int64_opt>& type_doc,
+                         const Parse_Opts&                          parse_opts,
+                         const std::string&                         dir) -> SEXP {
+    const auto n_rows = R_xlen_t(std::size(array));
+
+    switch (type_doc.common_R_type()) {
+        case rcpp_T::chr:
+            return spill_col<STRSXP, std::string, rcpp_T::chr>(
+                String_Column(dir, n_rows), array, key, type_doc);
+
+        case rcpp_T::dbl:
+            return spill_col<REALSXP, double, rcpp_T::dbl>(
+                Column<REALSXP>(dir, n_rows, NA_REAL), array, key, type_doc);
+
+        case rcpp_T::i32:
+            return spill_col<INTSXP, int64_t, rcpp_T::i32>(
+                Column<INTSXP>(dir, n_rows, NA_INTEGER), array, key, type_doc);
+
+        case rcpp_T::lgl:
+            return spill_col<LGLSXP, bool, rcpp_T::lgl>(
+                Column<LGLSXP>(dir, n_rows, NA_LOGICAL), array, key, type_doc);
+
+        case rcpp_T::u64:
+            return spill_col<STRSXP, uint64_t, rcpp_T::chr>(
+                String_Column(dir, n_rows), array, key, type_doc);
+
+        case rcpp_T::i64: {
+            if constexpr (int64_opt == utils::Int64_R_Type::Double) {
+                return spill_col<REALSXP, int64_t, rcpp_T::dbl>(
+                    Column<REALSXP>(dir, n_rows, NA_REAL), array, key, type_doc);
+            }
+
+            if constexpr (int64_opt == utils::Int64_R_Type::String) {
+                return spill_col<STRSXP, int64_t, rcpp_T::chr>(
+                    String_Column(dir, n_rows), array, key, type_doc);
+            }
+
+            if constexpr (int64_opt == utils::Int64_R_Type::Integer64 ||
+                          int64_opt == utils::Int64_R_Type::Always) {
+                auto column = Column<REALSXP>(dir, n_rows, utils::int64_bits(NA_INTEGER64));
+                fill_col_integer64(array, key, type_doc, column);
+                auto out          = Rcpp::RObject(column.vector());
+                out.attr("class") = "integer64";
+                return out;
+            }
+        }
+            [[fallthrough]];
+
+        default:
+            return build_column<type_policy, int64_opt, Simplify_To::data_frame>(
+                array,
+                key,
+                type_doc,
+                parse_opts.empty_array,
+                parse_opts.empty_object,
+                parse_opts.single_null);
+    }
+}
+
+
+/**
+ * @brief A data frame like build_data_frame()'s, but whose numeric, logical, and character columns
+ * are spilled to files in `dir`.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline auto build_data_frame(const simdjson::dom::array                  array,
+                             const Column_Schema<type_policy, int64_opt>& cols,
+                             const Parse_Opts&                            parse_opts,
+                             const std::string&                           dir) -> SEXP {
+    const auto n_rows    = R_xlen_t(std::size(array));
+    auto       out       = Rcpp::List(std::size(cols.schema));
+    auto       out_names = Rcpp::CharacterVector(std::size(cols.schema));
+
+    for (auto&& [key, col] : cols.schema) {
+        out_names[col.index] = Rcpp::String(std::string(key));
+        out[col.index]       = spill_column(array, key, col.schema, parse_opts, dir);
+    }
+
+    out.attr("names")     = out_names;
+    out.attr("row.names") = Rcpp::seq_len(n_rows); /* `Rcpp::seq()` throws if `n_rows == 0` */
+    out.attr("class")     = "data.frame";
+
+    return out;
+}
+
+
+/**
+ * @brief A column of a data frame whose records are streamed from a file: `fill` sets row `i_row`
+ * from `record`, and `vector` finishes the column once every row has been.
+ */
+struct Streamed_Column {
+    std::function<void(simdjson::dom::element record, R_xlen_t i_row)> fill;
+    std::function<SEXP()>                                             vector;
+};
+
+
+template <int RTYPE,
+          typename scalar_T,
+          rcpp_T R_Type,
+          typename column_T,
+          Type_Policy         type_policy,
+          utils::Int64_R_Type int64_opt>
+inline auto stream_col(std::shared_ptr<column_T>                  column,
+                       const std::string_view                     key,
+                       const Type_Doctor<type_policy, int64_opt>& type_doc) -> Streamed_Column {
+    return {[column, key, type_doc](simdjson::dom::element record, const R_xlen_t i_row) {
+                auto rows = Rows_From<column_T>{*column, i_row};
+                fill_col<RTYPE, scalar_T, R_Type>(std::array{record}, key, type_doc, rows);
+            },
+            [column] { return column->vector(); }};
+}
+
+
+/**
+ * @brief A Streamed_Column spilled to files in `dir` like spill_column()'s, or in memory if it
+ * isn't double, integer, logical, integer64, or character.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline auto stream_column(const std::string_view                     key,
+                          const Type_Doctor<type_policy, int64_opt>& type_doc,
+                          const R_xlen_t                             n_rows,
+                          const Parse_Opts&                          parse_opts,
+                          const std::string&                         dir) -> Streamed_Column {
+    switch (type_doc.common_R_type()) {
+        case rcpp_T::chr:
+            return stream_col<STRSXP, std::string, rcpp_T::chr>(
+                std::make_shared<String_Column>(dir, n_rows), key, type_doc);
+
+        case rcpp_T::dbl:
+            return stream_col<REALSXP, double, rcpp_T::dbl>(
+                std::make_shared<Column<REALSXP>>(dir, n_rows, NA_REAL), key, type_doc);
+
+        case rcpp_T::i32:
+            return stream_col<INTSXP, int64_t, rcpp_T::i32>(
+                std::make_shared<Column<INTSXP>>(dir, n_rows, NA_INTEGER), key, type_doc);
+
+        case rcpp_T::lgl:
+            return stream_col<LGLSXP, bool, rcpp_T::lgl>(
+                std::make_shared<Column<LGLSXP>>(dir, n_rows, NA_LOGICAL), key, type_doc);
+
+        case rcpp_T::u64:
+            return stream_col<STRSXP, uint64_t, rcpp_T::chr>(
+                std::make_shared<String_Column>(dir, n_rows), key, type_doc);
+
+        case rcpp_T::null:
+            return {[](simdjson::dom::element, R_xlen_t) {},
+                    [n_rows] {
+                        return compact::compact(Rcpp::LogicalVector(n_rows, NA_LOGICAL));
+                    }};
+
+        case rcpp_T::i64: {
+            if constexpr (int64_opt == utils::Int64_R_Type::Double) {
+                return stream_col<REALSXP, int64_t, rcpp_T::dbl>(
+                    std::make_shared<Column<REALSXP>>(dir, n_rows, NA_REAL), key, type_doc);
+            }
+
+            if constexpr (int64_opt == utils::Int64_R_Type::String) {
+                return stream_col<STRSXP, int64_t, rcpp_T::chr>(
+                    std::make_shared<String_Column>(dir, n_rows), key, type_doc);
+            }
+
+            if constexpr (int64_opt == utils::Int64_R_Type::Integer64 ||
+                          int64_opt == utils::Int64_R_Type::Always) {
+                auto column = std::make_shared<Column<REALSXP>>(
+                    dir, n_rows, utils::int64_bits(NA_INTEGER64));
+                return {[column, key, type_doc](simdjson::dom::element record,
+                                                const R_xlen_t         i_row) {
+                            auto rows = Rows_From<Column<REALSXP>>{*column, i_row};
+                            fill_col_integer64(std::array{record}, key, type_doc, rows);
+                        },
+                        [column] {
+                            auto out          = Rcpp::RObject(column->vector());
+                            out.attr("class") = "integer64";
+                            return SEXP(out);
+                        }};
+            }
+        }
+            [[fallthrough]];
+
+        default: {
+            auto out = Rcpp::List(n_rows);
+            return {[out, key, &parse_opts](simdjson::dom::element record,
+                                            const R_xlen_t         i_row) mutable {
+                        simdjson::dom::element value;
+                        if (lookup(record, key).get(value) == simdjson::SUCCESS) {
+                            out[i_row] =
+                                simplify_element<type_policy, int64_opt, Simplify_To::data_frame>(
+                                    value,
+                                    parse_opts.empty_array,
+                                    parse_opts.empty_object,
+                                    parse_opts.single_null);
+                        } else {
+                            out[i_row] = NA_LOGICAL;
+                        }
+                    },
+                    [out] { return SEXP(out); }};
+        }
+    }
+}
+
+
+/**
+ * @brief The columns of the records in the file at `path`, diagnosed from a first pass over it,
+ * with their keys in `keys` (as the records themselves are gone once they've been diagnosed).
+ *
+ * @return The columns and the number of records, or `std::nullopt` if any record isn't an object.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline auto diagnose_records(const std::string& path, std::deque<std::string>& keys)
+    -> std::optional<std::pair<Column_Schema<type_policy, int64_opt>, R_xlen_t>> {
+    auto cols       = Column_Schema<type_policy, int64_opt>();
+    auto is_records = true;
+
+    const auto n_records =
+        records::for_each_record(path, [&cols, &keys, &is_records](simdjson::dom::element record) {
+            simdjson::dom::object object;
+            if (!is_records || record.get(object) != simdjson::SUCCESS) {
+                is_records = false;
+                return;
+            }
+            for (auto [key, value] : object) {
+                auto col = cols.schema.find(key);
+                if (col == std::end(cols.schema)) {
+                    const auto index = R_xlen_t(std::size(cols.schema));
+                    col              = cols.schema
+                              .emplace(keys.emplace_back(key),
+                                       deserialize::Column<type_policy, int64_opt>{index})
+                              .first;
+                }
+                col->second.schema.add_element(value);
+            }
+        });
+
+    if (!is_records) {
+        return std::nullopt;
+    }
+    return std::pair(std::move(cols), R_xlen_t(n_records));
+}
+
+
+/**
+ * @brief A data frame like build_data_frame()'s of the records in the file at `path`, whose
+ * columns are filled by a second pass over it.
+ */
+template <Type_Policy type_policy, utils::Int64_R_Type int64_opt>
+inline auto stream_data_frame(const std::string&                           path,
+                              const Column_Schema<type_policy, int64_opt>& cols,
+                              const R_xlen_t                               n_rows,
+                              const Parse_Opts&                            parse_opts,
+                              const std::string&                           dir) -> SEXP {
+    auto columns   = std::vector<Streamed_Column>(std::size(cols.schema));
+    auto out_names = Rcpp::CharacterVector(std::size(cols.schema));
+
+    for (auto&& [key, col] : cols.schema) {
+        out_names[col.index] = Rcpp::String(std::string(key));
+        columns[col.index]   = stream_column(key, col.schema, n_rows, parse_opts, dir);
+    }
+
+    const auto changed = [&path] { Rcpp::stop("'" + path + "' changed while it was being read."); };
+    auto       i_row   = R_xlen_t(0L);
+    const auto fill = [&columns, &i_row, n_rows, &changed](simdjson::dom::element record) {
+        if (i_row == n_rows) {
+            changed();
+        }
+        for (auto& column : columns) {
+            column.fill(record, i_row);
+        }
+        ++i_row;
+    };
+    records::for_each_record(path, fill);
+    if (i_row != n_rows) {
+        changed();
+    }
+
+    auto out = Rcpp::List(std::size(columns));
+    for (std::size_t j = 0; j < std::size(columns); ++j) {
+        out[j] = columns[j].vector();
+    }
+
+    out.attr("names")     = out_names;
+    out.attr("row.names") = Rcpp::seq_len(n_rows);
+    out.attr("class")     = "data.frame";
+
+    return out;
+}
+
+
+/**
+ * @brief Whether the first byte of the file at `path` that isn't whitespace is `[`.
+ */
+inline auto starts_with_array(const std::string& path) -> bool {
+    auto file  = std::ifstream(path, std::ios::binary);
+    auto first = char(0);
+    return (file >> first) && first == '[';
+}
+
+#else
+
+inline void register_classes(DllInfo*) {}
+
+#endif
+
+
+} // namespace spill
+
+
+/**
+ * @brief Deserialize an array of objects as a data frame whose double, integer, logical,
+ * integer64, and character columns live in memory-mapped files in `parse_opts.spill_dir` instead of
+ * R's memory.
+ *
+ * The columns are ALTREP vectors that R reads (and writes) through the mapping, so they can be
+ * larger than the memory available to R, though `parsed` (and any list columns) can't be; see
+ * load_spilled() for files that are never parsed whole. Its values are identical to the usual data
+ * frame's.
+ *
+ * @return The data frame, or `std::nullopt` if `parsed` must be deserialized as usual.
+ */
+inline auto deserialize_spilled([[maybe_unused]] simdjson::dom::element parsed,
+                                [[maybe_unused]] const Parse_Opts&      parse_opts)
+    -> std::optional<SEXP> {
+#ifdef RCPPSIMDJSON_HAS_SPILL
+    if (!spill::is_registered()) {
+        return std::nullopt; /* e.g. when used from another package's headers */
+    }
+
+    if (simdjson::dom::array array; parse_opts.simplify_to == Simplify_To::data_frame &&
+                                    parsed.get(array) == simdjson::SUCCESS &&
+                                    std::size(array) != 0) {
+        const auto dir   = Rcpp::as<std::string>(parse_opts.spill_dir);
+        const auto spill = [&array, &parse_opts, &dir](auto policy,
+                                                       auto int64_r_type) -> std::optional<SEXP> {
+            constexpr auto policy_v    = decltype(policy)::value;
+            constexpr auto int64_opt_v = decltype(int64_r_type)::value;
+            if (const auto cols = diagnose_data_frame<policy_v, int64_opt_v>(array)) {
+                return spill::build_data_frame<policy_v, int64_opt_v>(
+                    array, *cols, parse_opts, dir);
+            }
+            return std::nullopt;
+        };
+        return dispatch_parse_opts(parse_opts, spill);
+    }
+#endif
+
+    return std::nullopt;
+}
+
+
+/**
+ * @brief Load the file at `path` as a data frame like deserialize_spilled() does, but by streaming
+ * its records through records::for_each_record() twice: once to diagnose its columns, then again to
+ * fill them.
+ *
+ * Neither the file nor its parsed document is ever in memory whole, so (as long as its list
+ * columns fit) the data frame can be larger than the memory available to R.
+ *
+ * @return The data frame, or `std::nullopt` if the file must be parsed as usual: when it isn't an
+ * uncompressed top-level array of objects, or its rows need to be typed, selected, or filtered.
+ */
+inline auto load_spilled([[maybe_unused]] const std::string& path,
+                         [[maybe_unused]] const Parse_Opts&  parse_opts) -> std::optional<SEXP> {
+#ifdef RCPPSIMDJSON_HAS_SPILL
+    if (!spill::is_registered() || parse_opts.simplify_to != Simplify_To::data_frame ||
+        parse_opts.schema != R_NilValue || parse_opts.select != R_NilValue ||
+        parse_opts.filter != R_NilValue || utils::get_memDecompress_type(std::string_view(path)) ||
+        !spill::starts_with_array(path)) {
+        return std::nullopt;
+    }
+
+    const auto dir  = Rcpp::as<std::string>(parse_opts.spill_dir);
+    const auto load = [&path, &parse_opts, &dir](auto policy,
+                                                 auto int64_r_type) -> std::optional<SEXP> {
+        constexpr auto policy_v    = decltype(policy)::value;
+        constexpr auto int64_opt_v = decltype(int64_r_type)::value;
+
+        auto keys = std::deque<std::string>(); /* the columns' keys point into these */
+        auto cols = std::optional<std::pair<Column_Schema<policy_v, int64_opt_v>, R_xlen_t>>();
+        try {
+            cols = spill::diagnose_records<policy_v, int64_opt_v>(path, keys);
+        } catch (const std::exception&) {
+            return std::nullopt; /* so that parsing the file reports what's wrong with it */
+        }
+        if (!cols || cols->second == 0) {
+            return std::nullopt;
+        }
+        return spill::stream_data_frame<policy_v, int64_opt_v>(
+            path, cols->first, cols->second, parse_opts, dir);
+    };
+    return dispatch_parse_opts(parse_opts, load);
+#else
+    return std::nullopt;
+#endif
+}
+
+
+} // namespace deserialize
+} // namespace rcppsimdjson
+
+
+#endif
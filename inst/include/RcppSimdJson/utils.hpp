@@ -6,6 +6,10 @@
 
 
 #include <algorithm>   /* std::all_of */
+#include <array>       /* std::array */
+#include <charconv>    /* std::to_chars */
+#include <cstdio>      /* std::snprintf */
+#include <cstdlib>     /* std::strtod */
 #include <fstream>     /* std::ifstream */
 #include <type_traits> /* std::remove_cv_t or std::remove_reference_t */
 #include <optional>    /* std::optional */
@@ -51,6 +55,66 @@ inline SEXP as_integer64(const std::vector<int64_t>& x) {
     out.attr("class") = "integer64";
     return out;
 }
+// Mark a `NumericVector` that already holds `int64_t` bit patterns as `bit64::integer64`.
+inline SEXP as_integer64(Rcpp::NumericVector x) {
+    x.attr("class") = "integer64";
+    return x;
+}
+
+
+// Reinterpret an `int64_t`'s bits as the `double` a `bit64::integer64` element stores.
+// Lets builders write straight into `REALSXP` storage instead of staging a `std::vector<int64_t>`.
+inline double int64_bits(const int64_t x) noexcept {
+    double out;
+    std::memcpy(&out, &x, sizeof(double));
+    return out;
+}
+
+
+// Big enough for any `int64_t`, `uint64_t`, or shortest round-trip `double` (plus a ".0" suffix).
+static inline constexpr auto NUMBER_BUFFER_SIZE = std::size_t(32ULL);
+
+
+// Write a number's text into `[first, last)`, returning the end of what was written.
+// - never allocates and is locale-independent
+// - `double`s get the shortest representation that parses back to the same value, via
+//   `std::to_chars()` when the standard library provides the floating point overloads and the
+//   smallest round-tripping `%.*g` precision otherwise
+// - integral `double`s keep a trailing ".0" so they still read as doubles (1.0 -> "1.0")
+template <typename number_T>
+inline char* format_number(char* first, char* last, const number_T x) noexcept {
+    if constexpr (std::is_integral_v<number_T>) {
+        return std::to_chars(first, last, x).ptr;
+    } else {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        auto end = std::to_chars(first, last, x).ptr;
+#else
+        auto end = first;
+        for (int precision = 15; precision <= 17; ++precision) {
+            end = first + std::snprintf(first, last - first, "%.*g", precision, x);
+            if (std::strtod(first, nullptr) == x) {
+                break;
+            }
+        }
+#endif
+        const auto is_integral = [](const char c) { return c == '-' || (c >= '0' && c <= '9'); };
+        if (std::all_of(first, end, is_integral)) {
+            *end++ = '.';
+            *end++ = '0';
+        }
+        return end;
+    }
+}
+
+
+// Convert a number to an `Rcpp::String`, formatting it on the stack via `format_number()`.
+template <typename number_T>
+inline Rcpp::String number_to_string(const number_T x) {
+    std::array<char, NUMBER_BUFFER_SIZE> buffer;
+    const auto end = format_number(buffer.data(), buffer.data() + buffer.size(), x);
+    return Rcpp::String(
+        Rf_mkCharLenCE(buffer.data(), static_cast<int>(end - buffer.data()), CE_UTF8));
+}
 
 
 // Check if big-ints can be losslessly downcasted to R integers.
@@ -63,6 +127,17 @@ inline constexpr bool is_castable_int64(const uint64_t x) noexcept {
     return false;
 }
 
+// Check if big-ints can be losslessly converted to doubles, i.e. whether they round-trip.
+// `2^63` and `2^64` are excluded before casting back, where the cast would overflow.
+inline constexpr bool is_exact_double(const int64_t x) noexcept {
+    const auto dbl = static_cast<double>(x);
+    return dbl < 9223372036854775808.0 && static_cast<int64_t>(dbl) == x;
+}
+inline constexpr bool is_exact_double(const uint64_t x) noexcept {
+    const auto dbl = static_cast<double>(x);
+    return dbl < 18446744073709551616.0 && static_cast<uint64_t>(dbl) == x;
+}
+
 
 // check if a `std::vector` containing big-ints can be losslessly copied into an
 // `Rcpp::IntegerVector` via iterators
@@ -95,7 +170,7 @@ inline SEXP resolve_int64(int64_t x) {
         }
 
         if constexpr (int64_opt == Int64_R_Type::String) {
-            return Rcpp::wrap(std::to_string(x));
+            return Rcpp::wrap(number_to_string(x));
         }
 
         if constexpr (int64_opt == Int64_R_Type::Integer64) {
@@ -121,7 +196,7 @@ inline SEXP resolve_int64(const std::vector<int64_t>& x) {
 
         if constexpr (int64_opt == Int64_R_Type::String) {
             return Rcpp::CharacterVector(
-                std::begin(x), std::end(x), [](int64_t val) { return std::to_string(val); });
+                std::begin(x), std::end(x), [](int64_t val) { return number_to_string(val); });
         }
 
         if constexpr (int64_opt == Int64_R_Type::Integer64) {
@@ -134,13 +209,13 @@ inline SEXP resolve_int64(const std::vector<int64_t>& x) {
 // converts `uint64_t` to `SEXP` (always string)
 template <Int64_R_Type int64_opt>
 inline SEXP resolve_int64(uint64_t x) {
-    return Rcpp::wrap(std::to_string(x));
+    return Rcpp::wrap(number_to_string(x));
 }
 // converts `std::vector<uint64_t>` to `SEXP` (always strings)
 template <Int64_R_Type int64_opt>
 inline SEXP resolve_int64(const std::vector<uint64_t>& x) {
     return Rcpp::CharacterVector(
-        std::begin(x), std::end(x), [](uint64_t val) { return std::to_string(val); });
+        std::begin(x), std::end(x), [](uint64_t val) { return number_to_string(val); });
 }
 
 
@@ -277,6 +352,9 @@ inline bool is_single_json_arg(SEXP json) {
 
 
 inline bool is_single_query_arg(SEXP query) {
+    if (TYPEOF(query) == EXTPTRSXP) { /* a `json_pointer()` keeps its original queries */
+        query = Rf_getAttrib(query, Rf_install("query"));
+    }
     return TYPEOF(query) == STRSXP && Rf_xlength(query) == 1;
 }
 
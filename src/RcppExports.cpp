@@ -13,9 +13,125 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// aggregate_json
+Rcpp::NumericVector aggregate_json(SEXP json, const std::string& path, const Rcpp::CharacterVector& fun, const int n_threads);
+RcppExport SEXP _RcppSimdJson_aggregate_json(SEXP jsonSEXP, SEXP pathSEXP, SEXP funSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type json(jsonSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::CharacterVector& >::type fun(funSEXP);
+    Rcpp::traits::input_parameter< const int >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(aggregate_json(json, path, fun, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// deserialize_arrow
+SEXP deserialize_arrow(SEXP json, SEXP query, const bool is_file, const bool parse_error_ok, const bool query_error_ok, const int type_policy);
+RcppExport SEXP _RcppSimdJson_deserialize_arrow(SEXP jsonSEXP, SEXP querySEXP, SEXP is_fileSEXP, SEXP parse_error_okSEXP, SEXP query_error_okSEXP, SEXP type_policySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type json(jsonSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type query(querySEXP);
+    Rcpp::traits::input_parameter< const bool >::type is_file(is_fileSEXP);
+    Rcpp::traits::input_parameter< const bool >::type parse_error_ok(parse_error_okSEXP);
+    Rcpp::traits::input_parameter< const bool >::type query_error_ok(query_error_okSEXP);
+    Rcpp::traits::input_parameter< const int >::type type_policy(type_policySEXP);
+    rcpp_result_gen = Rcpp::wrap(deserialize_arrow(json, query, is_file, parse_error_ok, query_error_ok, type_policy));
+    return rcpp_result_gen;
+END_RCPP
+}
+// convert_ndjson
+Rcpp::NumericVector convert_ndjson(const std::string& input, const std::string& output, const bool is_file, const double batch_size, const int type_policy);
+RcppExport SEXP _RcppSimdJson_convert_ndjson(SEXP inputSEXP, SEXP outputSEXP, SEXP is_fileSEXP, SEXP batch_sizeSEXP, SEXP type_policySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< const bool >::type is_file(is_fileSEXP);
+    Rcpp::traits::input_parameter< const double >::type batch_size(batch_sizeSEXP);
+    Rcpp::traits::input_parameter< const int >::type type_policy(type_policySEXP);
+    rcpp_result_gen = Rcpp::wrap(convert_ndjson(input, output, is_file, batch_size, type_policy));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fload_cache_configure
+Rcpp::List fload_cache_configure(const double max_size, const int policy);
+RcppExport SEXP _RcppSimdJson_fload_cache_configure(SEXP max_sizeSEXP, SEXP policySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const double >::type max_size(max_sizeSEXP);
+    Rcpp::traits::input_parameter< const int >::type policy(policySEXP);
+    rcpp_result_gen = Rcpp::wrap(fload_cache_configure(max_size, policy));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fload_cache_info
+Rcpp::List fload_cache_info();
+RcppExport SEXP _RcppSimdJson_fload_cache_info() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(fload_cache_info());
+    return rcpp_result_gen;
+END_RCPP
+}
+// fload_cache_clear
+Rcpp::List fload_cache_clear();
+RcppExport SEXP _RcppSimdJson_fload_cache_clear() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(fload_cache_clear());
+    return rcpp_result_gen;
+END_RCPP
+}
+// deserialize_columns
+SEXP deserialize_columns(SEXP json, const Rcpp::CharacterVector& columns, SEXP base, SEXP types, const bool is_file, SEXP empty_array, SEXP empty_object, SEXP single_null, const bool parse_error_ok, SEXP on_parse_error, const int simplify_to, const int type_policy, const int int64_r_type);
+RcppExport SEXP _RcppSimdJson_deserialize_columns(SEXP jsonSEXP, SEXP columnsSEXP, SEXP baseSEXP, SEXP typesSEXP, SEXP is_fileSEXP, SEXP empty_arraySEXP, SEXP empty_objectSEXP, SEXP single_nullSEXP, SEXP parse_error_okSEXP, SEXP on_parse_errorSEXP, SEXP simplify_toSEXP, SEXP type_policySEXP, SEXP int64_r_typeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type json(jsonSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::CharacterVector& >::type columns(columnsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type base(baseSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type types(typesSEXP);
+    Rcpp::traits::input_parameter< const bool >::type is_file(is_fileSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type empty_array(empty_arraySEXP);
+    Rcpp::traits::input_parameter< SEXP >::type empty_object(empty_objectSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type single_null(single_nullSEXP);
+    Rcpp::traits::input_parameter< const bool >::type parse_error_ok(parse_error_okSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type on_parse_error(on_parse_errorSEXP);
+    Rcpp::traits::input_parameter< const int >::type simplify_to(simplify_toSEXP);
+    Rcpp::traits::input_parameter< const int >::type type_policy(type_policySEXP);
+    Rcpp::traits::input_parameter< const int >::type int64_r_type(int64_r_typeSEXP);
+    rcpp_result_gen = Rcpp::wrap(deserialize_columns(json, columns, base, types, is_file, empty_array, empty_object, single_null, parse_error_ok, on_parse_error, simplify_to, type_policy, int64_r_type));
+    return rcpp_result_gen;
+END_RCPP
+}
+// json_to_csv
+Rcpp::NumericVector json_to_csv(const std::string& input, const std::string& output, SEXP columns, const std::string& sep, const std::string& na, const bool header);
+RcppExport SEXP _RcppSimdJson_json_to_csv(SEXP inputSEXP, SEXP outputSEXP, SEXP columnsSEXP, SEXP sepSEXP, SEXP naSEXP, SEXP headerSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type columns(columnsSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type sep(sepSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type na(naSEXP);
+    Rcpp::traits::input_parameter< const bool >::type header(headerSEXP);
+    rcpp_result_gen = Rcpp::wrap(json_to_csv(input, output, columns, sep, na, header));
+    return rcpp_result_gen;
+END_RCPP
+}
 // deserialize
-SEXP deserialize(SEXP json, SEXP query, SEXP empty_array, SEXP empty_object, SEXP single_null, const bool parse_error_ok, SEXP on_parse_error, const bool query_error_ok, SEXP on_query_error, const int simplify_to, const int type_policy, const int int64_r_type);
-static SEXP _RcppSimdJson_deserialize_try(SEXP jsonSEXP, SEXP querySEXP, SEXP empty_arraySEXP, SEXP empty_objectSEXP, SEXP single_nullSEXP, SEXP parse_error_okSEXP, SEXP on_parse_errorSEXP, SEXP query_error_okSEXP, SEXP on_query_errorSEXP, SEXP simplify_toSEXP, SEXP type_policySEXP, SEXP int64_r_typeSEXP) {
+SEXP deserialize(SEXP json, SEXP query, SEXP empty_array, SEXP empty_object, SEXP single_null, const bool parse_error_ok, SEXP on_parse_error, const bool query_error_ok, SEXP on_query_error, const int simplify_to, const int type_policy, const int int64_r_type, SEXP schema, const int schema_sample, SEXP select, SEXP filter, const bool dedupe_inputs, const bool lazy, SEXP spill_dir);
+static SEXP _RcppSimdJson_deserialize_try(SEXP jsonSEXP, SEXP querySEXP, SEXP empty_arraySEXP, SEXP empty_objectSEXP, SEXP single_nullSEXP, SEXP parse_error_okSEXP, SEXP on_parse_errorSEXP, SEXP query_error_okSEXP, SEXP on_query_errorSEXP, SEXP simplify_toSEXP, SEXP type_policySEXP, SEXP int64_r_typeSEXP, SEXP schemaSEXP, SEXP schema_sampleSEXP, SEXP selectSEXP, SEXP filterSEXP, SEXP dedupe_inputsSEXP, SEXP lazySEXP, SEXP spill_dirSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< SEXP >::type json(jsonSEXP);
@@ -30,15 +146,22 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const int >::type simplify_to(simplify_toSEXP);
     Rcpp::traits::input_parameter< const int >::type type_policy(type_policySEXP);
     Rcpp::traits::input_parameter< const int >::type int64_r_type(int64_r_typeSEXP);
-    rcpp_result_gen = Rcpp::wrap(deserialize(json, query, empty_array, empty_object, single_null, parse_error_ok, on_parse_error, query_error_ok, on_query_error, simplify_to, type_policy, int64_r_type));
+    Rcpp::traits::input_parameter< SEXP >::type schema(schemaSEXP);
+    Rcpp::traits::input_parameter< const int >::type schema_sample(schema_sampleSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type select(selectSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< const bool >::type dedupe_inputs(dedupe_inputsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type lazy(lazySEXP);
+    Rcpp::traits::input_parameter< SEXP >::type spill_dir(spill_dirSEXP);
+    rcpp_result_gen = Rcpp::wrap(deserialize(json, query, empty_array, empty_object, single_null, parse_error_ok, on_parse_error, query_error_ok, on_query_error, simplify_to, type_policy, int64_r_type, schema, schema_sample, select, filter, dedupe_inputs, lazy, spill_dir));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppSimdJson_deserialize(SEXP jsonSEXP, SEXP querySEXP, SEXP empty_arraySEXP, SEXP empty_objectSEXP, SEXP single_nullSEXP, SEXP parse_error_okSEXP, SEXP on_parse_errorSEXP, SEXP query_error_okSEXP, SEXP on_query_errorSEXP, SEXP simplify_toSEXP, SEXP type_policySEXP, SEXP int64_r_typeSEXP) {
+RcppExport SEXP _RcppSimdJson_deserialize(SEXP jsonSEXP, SEXP querySEXP, SEXP empty_arraySEXP, SEXP empty_objectSEXP, SEXP single_nullSEXP, SEXP parse_error_okSEXP, SEXP on_parse_errorSEXP, SEXP query_error_okSEXP, SEXP on_query_errorSEXP, SEXP simplify_toSEXP, SEXP type_policySEXP, SEXP int64_r_typeSEXP, SEXP schemaSEXP, SEXP schema_sampleSEXP, SEXP selectSEXP, SEXP filterSEXP, SEXP dedupe_inputsSEXP, SEXP lazySEXP, SEXP spill_dirSEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppSimdJson_deserialize_try(jsonSEXP, querySEXP, empty_arraySEXP, empty_objectSEXP, single_nullSEXP, parse_error_okSEXP, on_parse_errorSEXP, query_error_okSEXP, on_query_errorSEXP, simplify_toSEXP, type_policySEXP, int64_r_typeSEXP));
+        rcpp_result_gen = PROTECT(_RcppSimdJson_deserialize_try(jsonSEXP, querySEXP, empty_arraySEXP, empty_objectSEXP, single_nullSEXP, parse_error_okSEXP, on_parse_errorSEXP, query_error_okSEXP, on_query_errorSEXP, simplify_toSEXP, type_policySEXP, int64_r_typeSEXP, schemaSEXP, schema_sampleSEXP, selectSEXP, filterSEXP, dedupe_inputsSEXP, lazySEXP, spill_dirSEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -59,8 +182,8 @@ RcppExport SEXP _RcppSimdJson_deserialize(SEXP jsonSEXP, SEXP querySEXP, SEXP em
     return rcpp_result_gen;
 }
 // load
-SEXP load(const Rcpp::CharacterVector& json, SEXP query, SEXP empty_array, SEXP empty_object, SEXP single_null, const bool parse_error_ok, SEXP on_parse_error, const bool query_error_ok, SEXP on_query_error, const int simplify_to, const int type_policy, const int int64_r_type);
-static SEXP _RcppSimdJson_load_try(SEXP jsonSEXP, SEXP querySEXP, SEXP empty_arraySEXP, SEXP empty_objectSEXP, SEXP single_nullSEXP, SEXP parse_error_okSEXP, SEXP on_parse_errorSEXP, SEXP query_error_okSEXP, SEXP on_query_errorSEXP, SEXP simplify_toSEXP, SEXP type_policySEXP, SEXP int64_r_typeSEXP) {
+SEXP load(const Rcpp::CharacterVector& json, SEXP query, SEXP empty_array, SEXP empty_object, SEXP single_null, const bool parse_error_ok, SEXP on_parse_error, const bool query_error_ok, SEXP on_query_error, const int simplify_to, const int type_policy, const int int64_r_type, SEXP schema, const int schema_sample, SEXP select, SEXP filter, const bool dedupe_inputs, const bool lazy, SEXP spill_dir);
+static SEXP _RcppSimdJson_load_try(SEXP jsonSEXP, SEXP querySEXP, SEXP empty_arraySEXP, SEXP empty_objectSEXP, SEXP single_nullSEXP, SEXP parse_error_okSEXP, SEXP on_parse_errorSEXP, SEXP query_error_okSEXP, SEXP on_query_errorSEXP, SEXP simplify_toSEXP, SEXP type_policySEXP, SEXP int64_r_typeSEXP, SEXP schemaSEXP, SEXP schema_sampleSEXP, SEXP selectSEXP, SEXP filterSEXP, SEXP dedupe_inputsSEXP, SEXP lazySEXP, SEXP spill_dirSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::traits::input_parameter< const Rcpp::CharacterVector& >::type json(jsonSEXP);
@@ -75,15 +198,22 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const int >::type simplify_to(simplify_toSEXP);
     Rcpp::traits::input_parameter< const int >::type type_policy(type_policySEXP);
     Rcpp::traits::input_parameter< const int >::type int64_r_type(int64_r_typeSEXP);
-    rcpp_result_gen = Rcpp::wrap(load(json, query, empty_array, empty_object, single_null, parse_error_ok, on_parse_error, query_error_ok, on_query_error, simplify_to, type_policy, int64_r_type));
+    Rcpp::traits::input_parameter< SEXP >::type schema(schemaSEXP);
+    Rcpp::traits::input_parameter< const int >::type schema_sample(schema_sampleSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type select(selectSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< const bool >::type dedupe_inputs(dedupe_inputsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type lazy(lazySEXP);
+    Rcpp::traits::input_parameter< SEXP >::type spill_dir(spill_dirSEXP);
+    rcpp_result_gen = Rcpp::wrap(load(json, query, empty_array, empty_object, single_null, parse_error_ok, on_parse_error, query_error_ok, on_query_error, simplify_to, type_policy, int64_r_type, schema, schema_sample, select, filter, dedupe_inputs, lazy, spill_dir));
     return rcpp_result_gen;
 END_RCPP_RETURN_ERROR
 }
-RcppExport SEXP _RcppSimdJson_load(SEXP jsonSEXP, SEXP querySEXP, SEXP empty_arraySEXP, SEXP empty_objectSEXP, SEXP single_nullSEXP, SEXP parse_error_okSEXP, SEXP on_parse_errorSEXP, SEXP query_error_okSEXP, SEXP on_query_errorSEXP, SEXP simplify_toSEXP, SEXP type_policySEXP, SEXP int64_r_typeSEXP) {
+RcppExport SEXP _RcppSimdJson_load(SEXP jsonSEXP, SEXP querySEXP, SEXP empty_arraySEXP, SEXP empty_objectSEXP, SEXP single_nullSEXP, SEXP parse_error_okSEXP, SEXP on_parse_errorSEXP, SEXP query_error_okSEXP, SEXP on_query_errorSEXP, SEXP simplify_toSEXP, SEXP type_policySEXP, SEXP int64_r_typeSEXP, SEXP schemaSEXP, SEXP schema_sampleSEXP, SEXP selectSEXP, SEXP filterSEXP, SEXP dedupe_inputsSEXP, SEXP lazySEXP, SEXP spill_dirSEXP) {
     SEXP rcpp_result_gen;
     {
         Rcpp::RNGScope rcpp_rngScope_gen;
-        rcpp_result_gen = PROTECT(_RcppSimdJson_load_try(jsonSEXP, querySEXP, empty_arraySEXP, empty_objectSEXP, single_nullSEXP, parse_error_okSEXP, on_parse_errorSEXP, query_error_okSEXP, on_query_errorSEXP, simplify_toSEXP, type_policySEXP, int64_r_typeSEXP));
+        rcpp_result_gen = PROTECT(_RcppSimdJson_load_try(jsonSEXP, querySEXP, empty_arraySEXP, empty_objectSEXP, single_nullSEXP, parse_error_okSEXP, on_parse_errorSEXP, query_error_okSEXP, on_query_errorSEXP, simplify_toSEXP, type_policySEXP, int64_r_typeSEXP, schemaSEXP, schema_sampleSEXP, selectSEXP, filterSEXP, dedupe_inputsSEXP, lazySEXP, spill_dirSEXP));
     }
     Rboolean rcpp_isInterrupt_gen = Rf_inherits(rcpp_result_gen, "interrupted-error");
     if (rcpp_isInterrupt_gen) {
@@ -159,13 +289,16 @@ BEGIN_RCPP
 END_RCPP
 }
 // dispatch_fminify
-Rcpp::CharacterVector dispatch_fminify(SEXP json);
-RcppExport SEXP _RcppSimdJson_dispatch_fminify(SEXP jsonSEXP) {
+SEXP dispatch_fminify(SEXP json, const bool text, const bool validate, const bool as_raw);
+RcppExport SEXP _RcppSimdJson_dispatch_fminify(SEXP jsonSEXP, SEXP textSEXP, SEXP validateSEXP, SEXP as_rawSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< SEXP >::type json(jsonSEXP);
-    rcpp_result_gen = Rcpp::wrap(dispatch_fminify(json));
+    Rcpp::traits::input_parameter< const bool >::type text(textSEXP);
+    Rcpp::traits::input_parameter< const bool >::type validate(validateSEXP);
+    Rcpp::traits::input_parameter< const bool >::type as_raw(as_rawSEXP);
+    rcpp_result_gen = Rcpp::wrap(dispatch_fminify(json, text, validate, as_raw));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -191,6 +324,17 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// compile_json_pointer
+SEXP compile_json_pointer(const Rcpp::CharacterVector& query);
+RcppExport SEXP _RcppSimdJson_compile_json_pointer(SEXP querySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::CharacterVector& >::type query(querySEXP);
+    rcpp_result_gen = Rcpp::wrap(compile_json_pointer(query));
+    return rcpp_result_gen;
+END_RCPP
+}
 // diagnose_input
 SEXP diagnose_input(const Rcpp::CharacterVector& x);
 RcppExport SEXP _RcppSimdJson_diagnose_input(SEXP xSEXP) {
@@ -202,6 +346,19 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// write_ndjson
+double write_ndjson(SEXP df, Rcpp::Function write, const int n_threads);
+RcppExport SEXP _RcppSimdJson_write_ndjson(SEXP dfSEXP, SEXP writeSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type df(dfSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Function >::type write(writeSEXP);
+    Rcpp::traits::input_parameter< const int >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(write_ndjson(df, write, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // check_int64
 SEXP check_int64();
 RcppExport SEXP _RcppSimdJson_check_int64() {
@@ -212,6 +369,21 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// serialize_json
+SEXP serialize_json(SEXP x, const bool dataframe_rows, const bool auto_unbox, const bool as_raw, SEXP file);
+RcppExport SEXP _RcppSimdJson_serialize_json(SEXP xSEXP, SEXP dataframe_rowsSEXP, SEXP auto_unboxSEXP, SEXP as_rawSEXP, SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const bool >::type dataframe_rows(dataframe_rowsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type auto_unbox(auto_unboxSEXP);
+    Rcpp::traits::input_parameter< const bool >::type as_raw(as_rawSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(serialize_json(x, dataframe_rows, auto_unbox, as_raw, file));
+    return rcpp_result_gen;
+END_RCPP
+}
 // validateJSON
 bool validateJSON(const std::string filename);
 RcppExport SEXP _RcppSimdJson_validateJSON(SEXP filenameSEXP) {
@@ -257,8 +429,8 @@ END_RCPP
 static int _RcppSimdJson_RcppExport_validate(const char* sig) { 
     static std::set<std::string> signatures;
     if (signatures.empty()) {
-        signatures.insert("SEXP(*.deserialize_json)(SEXP,SEXP,SEXP,SEXP,SEXP,const bool,SEXP,const bool,SEXP,const int,const int,const int)");
-        signatures.insert("SEXP(*.load_json)(const Rcpp::CharacterVector&,SEXP,SEXP,SEXP,SEXP,const bool,SEXP,const bool,SEXP,const int,const int,const int)");
+        signatures.insert("SEXP(*.deserialize_json)(SEXP,SEXP,SEXP,SEXP,SEXP,const bool,SEXP,const bool,SEXP,const int,const int,const int,SEXP,const int,SEXP,SEXP,const bool,const bool,SEXP)");
+        signatures.insert("SEXP(*.load_json)(const Rcpp::CharacterVector&,SEXP,SEXP,SEXP,SEXP,const bool,SEXP,const bool,SEXP,const int,const int,const int,SEXP,const int,SEXP,SEXP,const bool,const bool,SEXP)");
         signatures.insert("bool(*.exceptions_enabled)()");
     }
     return signatures.find(sig) != signatures.end();
@@ -274,16 +446,27 @@ RcppExport SEXP _RcppSimdJson_RcppExport_registerCCallable() {
 }
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_RcppSimdJson_deserialize", (DL_FUNC) &_RcppSimdJson_deserialize, 12},
-    {"_RcppSimdJson_load", (DL_FUNC) &_RcppSimdJson_load, 12},
+    {"_RcppSimdJson_aggregate_json", (DL_FUNC) &_RcppSimdJson_aggregate_json, 4},
+    {"_RcppSimdJson_deserialize_arrow", (DL_FUNC) &_RcppSimdJson_deserialize_arrow, 6},
+    {"_RcppSimdJson_convert_ndjson", (DL_FUNC) &_RcppSimdJson_convert_ndjson, 5},
+    {"_RcppSimdJson_fload_cache_configure", (DL_FUNC) &_RcppSimdJson_fload_cache_configure, 2},
+    {"_RcppSimdJson_fload_cache_info", (DL_FUNC) &_RcppSimdJson_fload_cache_info, 0},
+    {"_RcppSimdJson_fload_cache_clear", (DL_FUNC) &_RcppSimdJson_fload_cache_clear, 0},
+    {"_RcppSimdJson_deserialize_columns", (DL_FUNC) &_RcppSimdJson_deserialize_columns, 13},
+    {"_RcppSimdJson_json_to_csv", (DL_FUNC) &_RcppSimdJson_json_to_csv, 6},
+    {"_RcppSimdJson_deserialize", (DL_FUNC) &_RcppSimdJson_deserialize, 19},
+    {"_RcppSimdJson_load", (DL_FUNC) &_RcppSimdJson_load, 19},
     {"_RcppSimdJson_exceptions_enabled", (DL_FUNC) &_RcppSimdJson_exceptions_enabled, 0},
     {"_RcppSimdJson_dispatch_is_valid_json", (DL_FUNC) &_RcppSimdJson_dispatch_is_valid_json, 1},
     {"_RcppSimdJson_dispatch_is_valid_utf8", (DL_FUNC) &_RcppSimdJson_dispatch_is_valid_utf8, 1},
-    {"_RcppSimdJson_dispatch_fminify", (DL_FUNC) &_RcppSimdJson_dispatch_fminify, 1},
+    {"_RcppSimdJson_dispatch_fminify", (DL_FUNC) &_RcppSimdJson_dispatch_fminify, 4},
     {"_RcppSimdJson_is_valid_json_arg", (DL_FUNC) &_RcppSimdJson_is_valid_json_arg, 1},
     {"_RcppSimdJson_is_valid_query_arg", (DL_FUNC) &_RcppSimdJson_is_valid_query_arg, 1},
+    {"_RcppSimdJson_compile_json_pointer", (DL_FUNC) &_RcppSimdJson_compile_json_pointer, 1},
     {"_RcppSimdJson_diagnose_input", (DL_FUNC) &_RcppSimdJson_diagnose_input, 1},
+    {"_RcppSimdJson_write_ndjson", (DL_FUNC) &_RcppSimdJson_write_ndjson, 3},
     {"_RcppSimdJson_check_int64", (DL_FUNC) &_RcppSimdJson_check_int64, 0},
+    {"_RcppSimdJson_serialize_json", (DL_FUNC) &_RcppSimdJson_serialize_json, 5},
     {"_RcppSimdJson_validateJSON", (DL_FUNC) &_RcppSimdJson_validateJSON, 1},
     {"_RcppSimdJson_parseExample", (DL_FUNC) &_RcppSimdJson_parseExample, 0},
     {"_RcppSimdJson_cppVersion", (DL_FUNC) &_RcppSimdJson_cppVersion, 0},
@@ -292,7 +475,13 @@ static const R_CallMethodDef CallEntries[] = {
     {NULL, NULL, 0}
 };
 
+void init_compact_classes(DllInfo* dll);
+void init_lazy_classes(DllInfo* dll);
+void init_spill_classes(DllInfo* dll);
 RcppExport void R_init_RcppSimdJson(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    init_compact_classes(dll);
+    init_lazy_classes(dll);
+    init_spill_classes(dll);
 }
@@ -0,0 +1,64 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::export(.aggregate_json)]]
+Rcpp::NumericVector aggregate_json(SEXP                         json,
+                                   const std::string&           path,
+                                   const Rcpp::CharacterVector& fun,
+                                   const int                    n_threads = 1) {
+    using namespace rcppsimdjson;
+
+    const auto tokens = pointer::tokenize(path);
+    if (!tokens) {
+        Rcpp::stop("`path=` must be a JSON Pointer, starting with \"/\" (or \"$/\").");
+    }
+
+    /* collect the documents first: R's API can't be used once parsing is parallelized */
+    auto docs = std::vector<std::optional<std::string_view>>();
+    switch (TYPEOF(json)) {
+        case STRSXP:
+            docs.reserve(Rf_xlength(json));
+            for (R_xlen_t i = 0; i < Rf_xlength(json); ++i) {
+                if (const auto doc = STRING_ELT(json, i); doc != NA_STRING) {
+                    docs.emplace_back(std::string_view(CHAR(doc), Rf_xlength(doc)));
+                } else {
+                    docs.emplace_back(std::nullopt);
+                }
+            }
+            break;
+
+        case RAWSXP:
+            docs.emplace_back(
+                std::string_view(reinterpret_cast<const char*>(RAW(json)), Rf_xlength(json)));
+            break;
+
+        default:
+            docs.reserve(Rf_xlength(json));
+            for (R_xlen_t i = 0; i < Rf_xlength(json); ++i) {
+                const auto doc = VECTOR_ELT(json, i);
+                docs.emplace_back(
+                    std::string_view(reinterpret_cast<const char*>(RAW(doc)), Rf_xlength(doc)));
+            }
+    }
+
+    auto funs = std::vector<std::string_view>();
+    for (R_xlen_t i = 0; i < r_length(fun); ++i) {
+        funs.emplace_back(CHAR(STRING_ELT(fun, i)));
+    }
+    const auto track_distinct =
+        std::find(std::begin(funs), std::end(funs), "n_distinct") != std::end(funs);
+
+    auto       first_error = std::optional<R_xlen_t>();
+    const auto acc = aggregate::reduce(docs, *tokens, track_distinct, n_threads, first_error);
+    if (first_error) {
+        Rcpp::stop("`json[[%d]]` is not valid JSON.", *first_error + 1);
+    }
+
+    auto out = Rcpp::NumericVector(std::size(funs));
+    for (std::size_t i = 0; i < std::size(funs); ++i) {
+        out[i] = acc.result(funs[i]);
+    }
+    out.attr("names") = fun;
+
+    return out;
+}
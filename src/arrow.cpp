@@ -0,0 +1,60 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::export(.deserialize_arrow)]]
+SEXP deserialize_arrow(SEXP       json,
+                       SEXP       query          = R_NilValue,
+                       const bool is_file        = false,
+                       const bool parse_error_ok = false,
+                       const bool query_error_ok = false,
+                       const int  type_policy    = 0) {
+    using namespace rcppsimdjson;
+
+    const auto policy = static_cast<deserialize::Type_Policy>(type_policy);
+
+    auto out = Rcpp::List();
+    switch (TYPEOF(json)) {
+        case STRSXP: {
+            const auto docs = Rcpp::CharacterVector(json);
+            out = is_file ? arrow::export_json<Rcpp::CharacterVector, deserialize::IS_FILE>(
+                                docs, query, parse_error_ok, query_error_ok, policy)
+                          : arrow::export_json<Rcpp::CharacterVector, deserialize::IS_NOT_FILE>(
+                                docs, query, parse_error_ok, query_error_ok, policy);
+            break;
+        }
+
+        default: {
+            /* a single raw vector is a single document */
+            const auto docs = Rcpp::ListOf<Rcpp::RawVector>(
+                TYPEOF(json) == RAWSXP ? Rcpp::List::create(json) : Rcpp::List(json));
+            out = arrow::export_json<Rcpp::ListOf<Rcpp::RawVector>, deserialize::IS_NOT_FILE>(
+                docs, query, parse_error_ok, query_error_ok, policy);
+            break;
+        }
+    }
+
+    if (TYPEOF(json) != RAWSXP) {
+        out.attr("names") = Rf_getAttrib(json, R_NamesSymbol);
+    }
+    return out;
+}
+
+
+// [[Rcpp::export(.convert_ndjson)]]
+Rcpp::NumericVector convert_ndjson(const std::string& input,
+                                   const std::string& output,
+                                   const bool         is_file     = false,
+                                   const double       batch_size  = 65536,
+                                   const int          type_policy = 0) {
+    using namespace rcppsimdjson;
+
+    const auto [n_records, n_batches] =
+        arrow::ipc::convert_ndjson(input,
+                                   output,
+                                   is_file,
+                                   static_cast<int64_t>(batch_size),
+                                   static_cast<deserialize::Type_Policy>(type_policy));
+
+    return Rcpp::NumericVector::create(Rcpp::_["records"] = static_cast<double>(n_records),
+                                       Rcpp::_["batches"] = static_cast<double>(n_batches));
+}
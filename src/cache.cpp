@@ -0,0 +1,26 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::export(.fload_cache_configure)]]
+Rcpp::List fload_cache_configure(const double max_size, const int policy) {
+    using namespace rcppsimdjson;
+
+    cache::file_cache().configure(static_cast<std::size_t>(max_size),
+                                  static_cast<cache::Policy>(policy));
+    return cache::file_cache().info();
+}
+
+
+// [[Rcpp::export(.fload_cache_info)]]
+Rcpp::List fload_cache_info() {
+    return rcppsimdjson::cache::file_cache().info();
+}
+
+
+// [[Rcpp::export(.fload_cache_clear)]]
+Rcpp::List fload_cache_clear() {
+    using namespace rcppsimdjson;
+
+    cache::file_cache().clear();
+    return cache::file_cache().info();
+}
@@ -0,0 +1,64 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::export(.deserialize_columns)]]
+SEXP deserialize_columns(SEXP                         json,
+                         const Rcpp::CharacterVector& columns,
+                         SEXP                         base           = R_NilValue,
+                         SEXP                         types          = R_NilValue,
+                         const bool                   is_file        = false,
+                         SEXP                         empty_array    = R_NilValue,
+                         SEXP                         empty_object   = R_NilValue,
+                         SEXP                         single_null    = R_NilValue,
+                         const bool                   parse_error_ok = false,
+                         SEXP                         on_parse_error = R_NilValue,
+                         const int                    simplify_to    = 0,
+                         const int                    type_policy    = 0,
+                         const int                    int64_r_type   = 0) {
+    using namespace rcppsimdjson;
+
+    const auto parse_opts =
+        deserialize::Parse_Opts{static_cast<deserialize::Simplify_To>(simplify_to),
+                                static_cast<deserialize::Type_Policy>(type_policy),
+                                static_cast<utils::Int64_R_Type>(int64_r_type),
+                                empty_array,
+                                empty_object,
+                                single_null,
+                                R_NilValue,
+                                0,
+                                R_NilValue,
+                                R_NilValue};
+
+    switch (TYPEOF(json)) {
+        case STRSXP: {
+            const auto docs = Rcpp::CharacterVector(json);
+            return is_file ? deserialize::build_document_columns<Rcpp::CharacterVector,
+                                                                 deserialize::IS_FILE>(
+                                 docs,
+                                 columns,
+                                 base,
+                                 types,
+                                 parse_error_ok,
+                                 on_parse_error,
+                                 parse_opts)
+                           : deserialize::build_document_columns<Rcpp::CharacterVector,
+                                                                 deserialize::IS_NOT_FILE>(
+                                 docs,
+                                 columns,
+                                 base,
+                                 types,
+                                 parse_error_ok,
+                                 on_parse_error,
+                                 parse_opts);
+        }
+
+        default: {
+            /* a single raw vector is a single document */
+            const auto docs = Rcpp::ListOf<Rcpp::RawVector>(
+                TYPEOF(json) == RAWSXP ? Rcpp::List::create(json) : Rcpp::List(json));
+            return deserialize::build_document_columns<Rcpp::ListOf<Rcpp::RawVector>,
+                                                       deserialize::IS_NOT_FILE>(
+                docs, columns, base, types, parse_error_ok, on_parse_error, parse_opts);
+        }
+    }
+}
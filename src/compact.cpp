@@ -0,0 +1,7 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::init]]
+void init_compact_classes(DllInfo* dll) {
+    rcppsimdjson::compact::register_classes(dll);
+}
@@ -0,0 +1,23 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::export(.json_to_csv)]]
+Rcpp::NumericVector json_to_csv(const std::string& input,
+                                const std::string& output,
+                                SEXP               columns = R_NilValue,
+                                const std::string& sep     = ",",
+                                const std::string& na      = "",
+                                const bool         header  = true) {
+    using namespace rcppsimdjson;
+
+    const auto [n_records, n_columns] = csv::json_to_csv(
+        input,
+        output,
+        Rf_isNull(columns) ? std::nullopt : std::optional(Rcpp::CharacterVector(columns)),
+        sep.front(),
+        na,
+        header);
+
+    return Rcpp::NumericVector::create(Rcpp::_["records"] = static_cast<double>(n_records),
+                                       Rcpp::_["columns"] = static_cast<double>(n_columns));
+}
@@ -16,7 +16,14 @@ SEXP deserialize(SEXP       json,
                  SEXP       on_query_error = R_NilValue,
                  const int  simplify_to    = 0,
                  const int  type_policy    = 0,
-                 const int  int64_r_type   = 0) {
+                 const int  int64_r_type   = 0,
+                 SEXP       schema         = R_NilValue,
+                 const int  schema_sample  = 0,
+                 SEXP       select         = R_NilValue,
+                 SEXP       filter         = R_NilValue,
+                 const bool dedupe_inputs  = false,
+                 const bool lazy           = false,
+                 SEXP       spill_dir      = R_NilValue) {
     using namespace rcppsimdjson;
 
     if (utils::is_single_json_arg(json)) {
@@ -34,7 +41,14 @@ SEXP deserialize(SEXP       json,
                                                                    on_query_error,
                                                                    simplify_to,
                                                                    type_policy,
-                                                                   int64_r_type)
+                                                                   int64_r_type,
+                                                                   schema,
+                                                                   schema_sample,
+                                                                   select,
+                                                                   filter,
+                                                                   dedupe_inputs,
+                                                                   lazy,
+                                                                   spill_dir)
                    : deserialize::start<deserialize::IS_NOT_FILE,
                                         deserialize::SINGLE_JSON,
                                         deserialize::NOT_SINGLE_QUERY>(json,
@@ -48,7 +62,14 @@ SEXP deserialize(SEXP       json,
                                                                        on_query_error,
                                                                        simplify_to,
                                                                        type_policy,
-                                                                       int64_r_type);
+                                                                       int64_r_type,
+                                                                       schema,
+                                                                       schema_sample,
+                                                                       select,
+                                                                       filter,
+                                                                       dedupe_inputs,
+                                                                       lazy,
+                                                                       spill_dir);
     } else { /* !is_single_json */
         return utils::is_single_query_arg(query)
                    ? deserialize::start<deserialize::IS_NOT_FILE,
@@ -64,7 +85,14 @@ SEXP deserialize(SEXP       json,
                                                                    on_query_error,
                                                                    simplify_to,
                                                                    type_policy,
-                                                                   int64_r_type)
+                                                                   int64_r_type,
+                                                                   schema,
+                                                                   schema_sample,
+                                                                   select,
+                                                                   filter,
+                                                                   dedupe_inputs,
+                                                                   lazy,
+                                                                   spill_dir)
                    : deserialize::start<deserialize::IS_NOT_FILE,
                                         deserialize::NOT_SINGLE_JSON,
                                         deserialize::NOT_SINGLE_QUERY>(json,
@@ -78,7 +106,14 @@ SEXP deserialize(SEXP       json,
                                                                        on_query_error,
                                                                        simplify_to,
                                                                        type_policy,
-                                                                       int64_r_type);
+                                                                       int64_r_type,
+                                                                       schema,
+                                                                       schema_sample,
+                                                                       select,
+                                                                       filter,
+                                                                       dedupe_inputs,
+                                                                       lazy,
+                                                                       spill_dir);
     }
 }
 
@@ -95,7 +130,14 @@ SEXP load(const Rcpp::CharacterVector& json,
           SEXP                         on_query_error = R_NilValue,
           const int                    simplify_to    = 0,
           const int                    type_policy    = 0,
-          const int                    int64_r_type   = 0) {
+          const int                    int64_r_type   = 0,
+          SEXP                         schema         = R_NilValue,
+          const int                    schema_sample  = 0,
+          SEXP                         select         = R_NilValue,
+          SEXP                         filter         = R_NilValue,
+          const bool                   dedupe_inputs  = false,
+          const bool                   lazy           = false,
+          SEXP                         spill_dir      = R_NilValue) {
     using namespace rcppsimdjson;
 
     if (utils::is_single_json_arg(json)) {
@@ -113,7 +155,14 @@ SEXP load(const Rcpp::CharacterVector& json,
                                                                    on_query_error,
                                                                    simplify_to,
                                                                    type_policy,
-                                                                   int64_r_type)
+                                                                   int64_r_type,
+                                                                   schema,
+                                                                   schema_sample,
+                                                                   select,
+                                                                   filter,
+                                                                   dedupe_inputs,
+                                                                   lazy,
+                                                                   spill_dir)
                    : deserialize::start<deserialize::IS_FILE,
                                         deserialize::SINGLE_JSON,
                                         deserialize::NOT_SINGLE_QUERY>(json,
@@ -127,7 +176,14 @@ SEXP load(const Rcpp::CharacterVector& json,
                                                                        on_query_error,
                                                                        simplify_to,
                                                                        type_policy,
-                                                                       int64_r_type);
+                                                                       int64_r_type,
+                                                                       schema,
+                                                                       schema_sample,
+                                                                       select,
+                                                                       filter,
+                                                                       dedupe_inputs,
+                                                                       lazy,
+                                                                       spill_dir);
     } else { /* !is_single_json */
         return utils::is_single_query_arg(query)
                    ? deserialize::start<deserialize::IS_FILE,
@@ -143,7 +199,14 @@ SEXP load(const Rcpp::CharacterVector& json,
                                                                    on_query_error,
                                                                    simplify_to,
                                                                    type_policy,
-                                                                   int64_r_type)
+                                                                   int64_r_type,
+                                                                   schema,
+                                                                   schema_sample,
+                                                                   select,
+                                                                   filter,
+                                                                   dedupe_inputs,
+                                                                   lazy,
+                                                                   spill_dir)
                    : deserialize::start<deserialize::IS_FILE,
                                         deserialize::NOT_SINGLE_JSON,
                                         deserialize::NOT_SINGLE_QUERY>(json,
@@ -157,7 +220,14 @@ SEXP load(const Rcpp::CharacterVector& json,
                                                                        on_query_error,
                                                                        simplify_to,
                                                                        type_policy,
-                                                                       int64_r_type);
+                                                                       int64_r_type,
+                                                                       schema,
+                                                                       schema_sample,
+                                                                       select,
+                                                                       filter,
+                                                                       dedupe_inputs,
+                                                                       lazy,
+                                                                       spill_dir);
     }
 }
 
@@ -134,83 +134,126 @@ Rcpp::LogicalVector dispatch_is_valid_utf8(SEXP x) {
 }
 
 
-template <typename vec_T>
-Rcpp::CharacterVector fminify(const vec_T json) {
-    simdjson::dom::parser p;
+/**
+ * @brief Minifies documents one at a time, into a single buffer reused across them.
+ *
+ * With `is_text`, whitespace is stripped from the text itself by `simdjson::minify()`'s SIMD pass,
+ * which builds no tape and keeps every other byte as is. Its output is then parsed (cheaper than
+ * parsing the original, as it's shorter) only if `validate`. Otherwise, each document is parsed,
+ * and its DOM is serialized.
+ */
+class Minifier {
+    simdjson::dom::parser parser;
+    std::vector<char>     buffer = std::vector<char>();
+    bool                  is_text;
+    bool                  validate;
 
-    if constexpr (std::is_same_v<vec_T, Rcpp::RawVector>) {
-        simdjson::dom::element parsed;
-        auto error = p.parse(
-            std::string_view(reinterpret_cast<const char*>(&(json[0])), std::size(json))).get(parsed);
-        if (!error) {
-            return simdjson::minify(parsed);
-        }
-        return Rcpp::CharacterVector::create(NA_STRING);
-    }
+  public:
+    Minifier(const bool is_text, const bool validate) : is_text(is_text), validate(validate) {}
 
-    if constexpr (std::is_same_v<vec_T, Rcpp::CharacterVector>) {
-        return Rcpp::CharacterVector(
-            std::cbegin(json), std::cend(json), [&p](const decltype(json[0]) val) -> Rcpp::String {
-                if (val != NA_STRING) {
-                    simdjson::dom::element parsed;
-                    auto error = p.parse(std::string_view(val)).get(parsed);
-                    if (!error) {
-                        return simdjson::minify(parsed);
-                    }
-                }
-                return NA_STRING;
-            });
-    }
+    /**
+     * @brief The minified `json`, valid until the next call, or std::nullopt if it's invalid.
+     */
+    inline auto minify(const std::string_view json) -> std::optional<std::string_view> {
+        if (!is_text) {
+            simdjson::dom::element parsed;
+            if (parser.parse(json).get(parsed) != simdjson::SUCCESS) {
+                return std::nullopt;
+            }
+            const auto minified = simdjson::minify(parsed);
+            buffer.assign(std::cbegin(minified), std::cend(minified));
+            return std::string_view(buffer.data(), std::size(buffer));
+        }
 
-    if constexpr (std::is_same_v<vec_T, Rcpp::ListOf<Rcpp::RawVector>>) {
-        return Rcpp::CharacterVector(
-            std::cbegin(json), std::cend(json), [&p](const Rcpp::RawVector val) -> Rcpp::String {
-                simdjson::dom::element parsed;
-                auto error = p.parse(
-                    std::string_view(reinterpret_cast<const char*>(&(val[0])), std::size(val))).get(parsed);
-                if (!error) {
-                    return simdjson::minify(parsed);
-                }
-                return NA_STRING;
-            });
+        buffer.resize(std::size(json) + simdjson::SIMDJSON_PADDING);
+        auto size = std::size_t(0);
+        if (simdjson::minify(json.data(), std::size(json), buffer.data(), size) !=
+            simdjson::SUCCESS) {
+            return std::nullopt;
+        }
+        if (validate && parser.parse(buffer.data(), size, false).error() != simdjson::SUCCESS) {
+            return std::nullopt;
+        }
+        return std::string_view(buffer.data(), size);
     }
-}
-//' @rdname simdjson-utilities
-//' @export
-// [[Rcpp::export(fminify)]]
-Rcpp::CharacterVector dispatch_fminify(SEXP json) {
+};
+// [[Rcpp::export(.fminify)]]
+SEXP dispatch_fminify(SEXP       json,
+                      const bool text     = false,
+                      const bool validate = true,
+                      const bool as_raw   = false) {
     if (Rf_xlength(json) == 0) {
         Rcpp::stop("`json=` must be a non-empty character vector, raw vector, or a list containing "
                    "raw vectors.");
     }
-
-    switch (TYPEOF(json)) {
-        case STRSXP: {
-            auto out          = fminify<Rcpp::CharacterVector>(json);
-            out.attr("names") = Rf_getAttrib(json, R_NamesSymbol);
-            return out;
+    if (TYPEOF(json) == VECSXP) {
+        for (auto&& element : Rcpp::List(json)) {
+            if (TYPEOF(element) != RAWSXP || Rf_xlength(element) == 0) {
+                Rcpp::stop("If `json=` is a `list`, it should only contain non-empty raw vectors.");
+            }
         }
+    } else if (TYPEOF(json) != STRSXP && TYPEOF(json) != RAWSXP) {
+        Rcpp::stop("`json=` must be a non-empty character vector, raw vector, or a list "
+                   "containing raw vectors.");
+    }
 
-        case RAWSXP: {
-            auto out          = fminify<Rcpp::RawVector>(json);
-            out.attr("names") = Rf_getAttrib(json, R_NamesSymbol);
-            return out;
+    const auto n_docs   = TYPEOF(json) == RAWSXP ? R_xlen_t(1) : Rf_xlength(json);
+    auto       strings  = Rcpp::CharacterVector(as_raw ? 0 : n_docs);
+    auto       raws     = Rcpp::List(as_raw ? n_docs : 0);
+    auto       minifier = Minifier(text, validate);
+
+    // text keeps its encoding if it isn't validated, as its bytes are kept as they are
+    const auto set = [&](const R_xlen_t i, const std::string_view doc, const cetype_t encoding) {
+        const auto minified = minifier.minify(doc);
+        if (!minified) {
+            if (!as_raw) {
+                strings[i] = NA_STRING;
+            }
+            return;
+        }
+        if (as_raw) {
+            auto out = Rcpp::RawVector(std::size(*minified));
+            std::copy(std::cbegin(*minified), std::cend(*minified), std::begin(out));
+            raws[i] = out;
+        } else {
+            strings[i] = Rf_mkCharLenCE(minified->data(),
+                                        static_cast<int>(std::size(*minified)),
+                                        text && !validate ? encoding : CE_UTF8);
         }
+    };
 
-        case VECSXP: {
-            for (auto&& element : Rcpp::List(json)) {
-                if (TYPEOF(element) != RAWSXP || Rf_xlength(element) == 0) {
-                    Rcpp::stop(
-                        "If `json=` is a `list`, it should only contain non-empty raw vectors.");
+    switch (TYPEOF(json)) {
+        case STRSXP:
+            for (R_xlen_t i = 0; i < n_docs; ++i) {
+                if (const auto x = STRING_ELT(json, i); x != NA_STRING) {
+                    set(i, std::string_view(CHAR(x), LENGTH(x)), Rf_getCharCE(x));
+                } else if (!as_raw) {
+                    strings[i] = NA_STRING;
                 }
             }
-            auto out          = fminify<Rcpp::ListOf<Rcpp::RawVector>>(json);
-            out.attr("names") = Rf_getAttrib(json, R_NamesSymbol);
-            return out;
-        }
+            break;
+
+        case RAWSXP:
+            set(0,
+                std::string_view(reinterpret_cast<const char*>(RAW(json)), Rf_xlength(json)),
+                CE_UTF8);
+            break;
 
         default:
-            Rcpp::stop("`json=` must be a non-empty character vector, raw vector, or a list "
-                       "containing raw vectors.");
+            for (R_xlen_t i = 0; i < n_docs; ++i) {
+                const auto x = VECTOR_ELT(json, i);
+                set(i,
+                    std::string_view(reinterpret_cast<const char*>(RAW(x)), Rf_xlength(x)),
+                    CE_UTF8);
+            }
+            break;
+    }
+
+    const auto names = TYPEOF(json) == RAWSXP ? R_NilValue : Rf_getAttrib(json, R_NamesSymbol);
+    if (as_raw) {
+        raws.attr("names") = names;
+        return raws;
     }
+    strings.attr("names") = names;
+    return strings;
 }
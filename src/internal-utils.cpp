@@ -1,4 +1,5 @@
 #include <RcppSimdJson/utils.hpp>
+#include <RcppSimdJson/pointer.hpp>
 
 // [[Rcpp::export(.is_valid_json_arg)]]
 bool is_valid_json_arg(SEXP json) {
@@ -28,6 +29,8 @@ bool is_valid_query_arg(SEXP query) {
             return true;
         case STRSXP:
             return Rf_xlength(query) > 0;
+        case EXTPTRSXP:
+            return Rf_inherits(query, "json_pointer");
         case VECSXP: {
             if (Rf_xlength(query) == 0) {
                 return false;   // #nocov
@@ -46,6 +49,16 @@ bool is_valid_query_arg(SEXP query) {
 }
 
 
+// [[Rcpp::export(.compile_json_pointer)]]
+SEXP compile_json_pointer(const Rcpp::CharacterVector& query) {
+    auto out = Rcpp::XPtr<rcppsimdjson::pointer::Query_Trie>(
+        new rcppsimdjson::pointer::Query_Trie(query));
+    out.attr("query") = query;
+    out.attr("class") = "json_pointer";
+    return out;
+}
+
+
 // [[Rcpp::export(.diagnose_input)]]
 SEXP diagnose_input(const Rcpp::CharacterVector& x) {
     const R_xlen_t n = std::size(x);
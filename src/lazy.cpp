@@ -0,0 +1,7 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::init]]
+void init_lazy_classes(DllInfo* dll) {
+    rcppsimdjson::deserialize::lazy::register_classes(dll);
+}
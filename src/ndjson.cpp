@@ -0,0 +1,16 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::export(.write_ndjson)]]
+double write_ndjson(SEXP df, Rcpp::Function write, const int n_threads = 1) {
+    using namespace rcppsimdjson;
+
+    const auto n_rows = serialize::write_ndjson(
+        df, serialize::Serialize_Opts(), n_threads, [&write](const char* bytes, std::size_t size) {
+            auto chunk = Rcpp::RawVector(size);
+            std::copy(bytes, bytes + size, std::begin(chunk));
+            write(chunk);
+        });
+
+    return static_cast<double>(n_rows);
+}
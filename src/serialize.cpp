@@ -0,0 +1,44 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::export(.serialize_json)]]
+SEXP serialize_json(SEXP       x,
+                    const bool dataframe_rows = true,
+                    const bool auto_unbox     = false,
+                    const bool as_raw         = false,
+                    SEXP       file           = R_NilValue) {
+    using namespace rcppsimdjson;
+
+    const auto opts = serialize::Serialize_Opts{dataframe_rows, auto_unbox};
+
+    if (!Rf_isNull(file)) {
+        const auto path = std::string(CHAR(STRING_ELT(file, 0)));
+        auto       out  = std::unique_ptr<std::FILE, decltype(&std::fclose)>(
+            std::fopen(path.c_str(), "wb"), &std::fclose);
+        if (!out) {
+            Rcpp::stop("Failed to open '" + path + "'.");
+        }
+        auto serializer = serialize::Serializer(opts, out.get());
+        serializer.write_value(x);
+        serializer.flush();
+        if (std::fclose(out.release()) != 0) {
+            Rcpp::stop("Failed to write to '" + path + "'."); // # nocov
+        }
+        return R_NilValue;
+    }
+
+    auto serializer = serialize::Serializer(opts);
+    serializer.write_value(x);
+    const auto& json = serializer.out;
+
+    if (as_raw) {
+        auto out = Rcpp::RawVector(std::size(json));
+        std::copy(std::begin(json), std::end(json), std::begin(out));
+        return out;
+    }
+
+    if (std::size(json) > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        Rcpp::stop("The JSON is too long for a string, so use `output = \"raw\"` or `file=`.");
+    }
+    return Rf_ScalarString(Rf_mkCharLenCE(json.data(), static_cast<int>(std::size(json)), CE_UTF8));
+}
@@ -0,0 +1,7 @@
+#include <RcppSimdJson.hpp>
+
+
+// [[Rcpp::init]]
+void init_spill_classes(DllInfo* dll) {
+    rcppsimdjson::deserialize::spill::register_classes(dll);
+}